@@ -2,8 +2,13 @@
 
 #pragma once
 #include <cstdint>
+#include <cstddef>
+#include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <tuple>
 #include <type_traits>
 
 namespace bagel
@@ -16,30 +21,49 @@ namespace bagel
 		int		IdBagSize = 10000;
 		int		InitialEntities = 10000;
 		int		InitialPackedSize = 10000;
-		int		MaxComponents = 10000;
+		int		MaxComponents = 0; // 0: one bit per component declared with BAGEL_STORAGE
+		bool	TrackWrites = false; // report World changes to Journal (for Rewind)
 	};
 
 	template <class T> struct Storage;
 	template <class T> class PackedStorage;
 	template <class T> class SparseStorage;
 	template <class T> class TaggedStorage;
+	template <class T> class ArchetypeStorage;
 
 #if __has_include("bagel_cfg.h")
-	#define BAGEL_STORAGE(C,T) template <> struct Storage<C> { using type = T<C>; };
+	constexpr inline int StorageCounterBase = __COUNTER__;
+	#define BAGEL_STORAGE(C,T) template <> struct Storage<C> { \
+		using type = T<C>; \
+		static constexpr int Index = __COUNTER__ - StorageCounterBase - 1; };
 	#include "bagel_cfg.h"
 	#undef BAGEL_STORAGE
+	constexpr inline int RegisteredComponents = __COUNTER__ - StorageCounterBase - 1;
 #else
 	constexpr Bagel Params{};
+	constexpr inline int RegisteredComponents = 0;
 #endif
 
 	using id_type = int;
-	struct ent_type { id_type id; };
+	// gen is bumped when the entity is destroyed (to an odd value: the id is free) and again
+	// when the id is reused (even: alive), so a handle kept past its entity's destruction no
+	// longer matches and a free id's own handle is not alive (World::isAlive).
+	struct ent_type {
+		id_type id;
+		id_type gen = 0;
+		bool operator==(const ent_type& o) const { return id == o.id && gen == o.gen; }
+		bool operator!=(const ent_type& o) const { return !(*this == o); }
+	};
 	using size_type = int;
 	using index_type = int;
+
+	constexpr inline size_type MaxComponents =
+		Params.MaxComponents > 0 ? Params.MaxComponents :
+		RegisteredComponents > 0 ? RegisteredComponents : 10000;
 	using mask_type =
-		std::conditional_t<Params.MaxComponents<=8, std::uint_fast8_t,
-		std::conditional_t<Params.MaxComponents<=16, std::uint_fast16_t,
-		std::conditional_t<Params.MaxComponents<=32, std::uint_fast32_t,
+		std::conditional_t<MaxComponents<=8, std::uint_fast8_t,
+		std::conditional_t<MaxComponents<=16, std::uint_fast16_t,
+		std::conditional_t<MaxComponents<=32, std::uint_fast32_t,
 			std::uint_fast64_t>>>;
 	constexpr inline size_type BitsetWidth = sizeof(mask_type)*8;
 
@@ -50,137 +74,252 @@ namespace bagel
 		void operator=(const NoCopy&) = delete;
 	};
 
-	template <class T, int N>
+	constexpr inline size_type ColumnAlign = 32;
+
+	template <class T, int N, int A = alignof(T)>
 	class DynamicBag : NoCopy
 	{
 	public:
+		using value_type = T;
+
 		void push(const T& t) {
-			if (_size == _capacity) {
-				_capacity *= 2;
-				_arr = static_cast<T*>(
-					realloc(_arr, sizeof(T)*_capacity));
-			}
+			if (_size == _capacity)
+				grow(_capacity > 0 ? _capacity*2 : N);
 			_arr[_size] = t;
 			++_size;
 		}
 		void ensure(size_type s) {
-			if (_capacity < s) {
-				_capacity = std::max(s, _capacity*2);
-				_arr = static_cast<T*>(
-					realloc(_arr, sizeof(T)*_capacity));
-			}
+			if (_capacity < s)
+				grow(std::max(s, _capacity*2));
 		}
 		T pop() { return _arr[--_size]; }
 		T& operator[](index_type i) { return _arr[i]; }
 		const T& operator[](index_type i) const { return _arr[i]; }
+		T* data() { return _arr; }
+		const T* data() const { return _arr; }
 		void clear() { _size = 0; }
+		void resize(size_type s) {
+			ensure(s);
+			_size = s;
+		}
+
+		// Uses n elements at arr in place (a mapped snapshot) instead of its own array.
+		// That memory is never freed; the first growth copies it to the heap.
+		void adopt(T* arr, size_type n) {
+			if (!_borrowed)
+				free(_arr);
+			_arr = arr;
+			_size = n;
+			_capacity = n;
+			_borrowed = true;
+		}
 
 		size_type size() const { return _size; }
 		size_type capacity() const { return _capacity; }
 
-		~DynamicBag() { free(_arr); }
+		~DynamicBag() {
+			if (!_borrowed)
+				free(_arr);
+		}
 	private:
-		T*			_arr = static_cast<T*>(malloc(sizeof(T) * N));
+		static constexpr bool OverAligned = A > alignof(std::max_align_t);
+
+		static T* alloc(size_type n) {
+			if constexpr (OverAligned)
+				return static_cast<T*>(aligned_alloc(A, (sizeof(T)*n + A-1) / A * A));
+			else
+				return static_cast<T*>(malloc(sizeof(T)*n));
+		}
+		void grow(size_type capacity) {
+			if (OverAligned || _borrowed) {
+				T* arr = alloc(capacity);
+				memcpy(arr, _arr, sizeof(T)*_capacity);
+				if (!_borrowed)
+					free(_arr);
+				_arr = arr;
+				_borrowed = false;
+			}
+			else
+				_arr = static_cast<T*>(realloc(_arr, sizeof(T)*capacity));
+			_capacity = capacity;
+		}
+
+		T*			_arr = alloc(N);
 		size_type	_size = 0;
 		size_type	_capacity = N;
+		bool		_borrowed = false;
 	};
-	template <class T, int N>
+	template <class T, int N, int A = alignof(T)>
 	class StaticBag
 	{
 	public:
+		using value_type = T;
+
 		void push(const T& t) { _arr[_size++] = t; }
 		T pop() { return _arr[--_size]; }
 		T& operator[](index_type i) { return _arr[i]; }
 		const T& operator[](index_type i) const { return _arr[i]; }
+		T* data() { return _arr; }
+		const T* data() const { return _arr; }
 		void clear() { _size = 0; }
+		void resize(size_type s) { _size = std::min(s, N); }
+
+		// A static bag cannot use outside memory: copies the elements (at most N).
+		void adopt(const T* arr, size_type n) {
+			_size = std::min(n, N);
+			memcpy(_arr, arr, sizeof(T)*_size);
+		}
 
 		size_type size() const { return _size; }
 		static constexpr size_type capacity() { return N; }
 		static void ensure(size_type) {}
 	private:
-		T			_arr[N];
-		size_type	_size = 0;
+		alignas(A) T	_arr[N];
+		size_type		_size = 0;
 	};
-	template <class T, int N>
-	using Bag = std::conditional_t<Params.DynamicResize, DynamicBag<T, N>, StaticBag<T,N>>;
+	template <class T, int N, int A = alignof(T)>
+	using Bag = std::conditional_t<Params.DynamicResize, DynamicBag<T,N,A>, StaticBag<T,N,A>>;
 
-	struct StorageCallbacks
-	{
-		using Destroy = void (*)(ent_type);
-		Destroy destroy = nullptr;
-	};
-	template <class> class StorageRegister;
-
-	template <class T>
-	class SparseStorage final : NoInstance
+	/**
+	 * The arrays making up a World snapshot (World::save/load, bagel_snapshot.h).
+	 * Saving records pointers to the live arrays, each tagged with its section (-1 for
+	 * World, otherwise the component index); loading hands arrays of the same layout
+	 * back in the same order, for the storages to adopt in place.
+	 */
+	class SnapshotBlocks : NoCopy
 	{
 	public:
-		static void add(ent_type e, const T& t) {
-			_bag.ensure(e.id);
-			_bag[e.id] = t;
+		struct Block {
+			void*		data;
+			index_type	tag;
+			size_type	elemSize;
+			size_type	count;
+		};
+
+		// Section of the following put()/take() calls.
+		void begin(index_type tag) { _tag = tag; }
+
+		template <class T>
+		void put(const T* data, size_type count) {
+			static_assert(std::is_trivially_copyable_v<T>, "snapshots store arrays as raw bytes");
+			_blocks.push({const_cast<T*>(data), _tag, static_cast<size_type>(sizeof(T)), count});
 		}
-		static void del(ent_type) {}
-		static T& get(ent_type e) { return _bag[e.id]; }
+		// Next block, if it belongs to the current section and holds elements of T
+		// (nullptr and count 0 otherwise).
+		template <class T>
+		T* take(size_type& count) {
+			count = 0;
+			if (_next >= _blocks.size() || _blocks[_next].tag != _tag || _blocks[_next].elemSize != sizeof(T))
+				return nullptr;
+			count = _blocks[_next].count;
+			return static_cast<T*>(_blocks[_next++].data);
+		}
+		// Makes the next block the content of a Bag.
+		template <class B>
+		void adopt(B& bag) {
+			size_type n;
+			typename B::value_type* data = take<typename B::value_type>(n);
+			bag.adopt(data, n);
+		}
+
+		// Same sections and element sizes, block by block.
+		bool sameLayout(const SnapshotBlocks& o) const {
+			if (_blocks.size() != o._blocks.size())
+				return false;
+			for (index_type i = 0; i < _blocks.size(); ++i)
+				if (_blocks[i].tag != o._blocks[i].tag || _blocks[i].elemSize != o._blocks[i].elemSize)
+					return false;
+			return true;
+		}
+
+		// Entities saved (maxId+1): bounds the per-id arrays of the storages.
+		size_type entities() const { return _entities; }
+		void setEntities(size_type n) { _entities = n; }
+
+		void add(const Block& b) { _blocks.push(b); }
+		void rewind() { _next = 0; }
+		void clear() { _blocks.clear(); _next = 0; }
+		size_type size() const { return _blocks.size(); }
+		const Block& operator[](index_type i) const { return _blocks[i]; }
 	private:
-		static inline Bag<T,Params.InitialEntities> _bag;
+		DynamicBag<Block,64>	_blocks;
+		index_type				_next = 0;
+		index_type				_tag = -1;
+		size_type				_entities = 0;
 	};
-	template <class T>
-	class PackedStorage final : NoInstance
+
+	/**
+	 * Write tracking of a World's state, for Rewind (bagel_rewind.h). With
+	 * Params.TrackWrites, the World and the states of its PackedStorage, SparseStorage and
+	 * Group register the arrays holding them in the World's journal, and report every
+	 * element they are about to change or hand out by mutable reference to the attached
+	 * sink, if any. Compiled out otherwise.
+	 */
+	class Journal : NoCopy
 	{
 	public:
-		static void add(ent_type e, const T& t) {
-			_entToComp.ensure(e.id);
-			_entToComp[e.id] = _comps.size();
-			_comps.push(t);
-			_compToEnt.push(e);
-		}
-		static void del(ent_type e) {
-			index_type ent_comp_idx = _entToComp[e.id];
-			ent_type last_ent = _compToEnt.pop();
+		struct Array {
+			void*		target;
+			size_type	elemSize;
+			unsigned char*	(*data)(void*);
+			size_type	(*extent)(void*);				// elements holding state
+			void		(*restore)(void*, size_type);	// sets the extent, growing if needed
+		};
+		using Sink = void (*)(void* ctx, index_type array, index_type first, size_type n);
 
-			_comps[ent_comp_idx] = _comps.pop();
-			_compToEnt[ent_comp_idx] = last_ent;
-			_entToComp[last_ent.id] = ent_comp_idx;
-		}
-		static T& get(ent_type e) {
-			return _comps[_entToComp[e.id]];
+		// Most arrays a World may register (they register as its storages are first used).
+		static constexpr size_type Capacity = Params.TrackWrites ? 8 + 4*MaxComponents : 1;
+
+		// Dense bags hold state up to their size, the others (indexed by id) up to capacity.
+		template <class B>
+		index_type trackBag(B& bag, bool dense) {
+			return track({&bag, sizeof(typename B::value_type), bagData<B>,
+				dense ? bagSize<B> : bagCapacity<B>, dense ? bagResize<B> : bagEnsure<B>});
 		}
-		static int size() { return _comps.size(); }
-		static T& get(index_type idx) {
-			return _comps[idx];
+		template <class T>
+		index_type trackValue(T& value) {
+			return track({&value, sizeof(T), valueData, valueExtent, valueRestore});
 		}
-		static ent_type entity(index_type idx) {
-			return _compToEnt[idx];
+
+		void write(index_type array, index_type first, size_type n = 1) {
+			if constexpr (Params.TrackWrites)
+				if (_sink != nullptr && n > 0)
+					_sink(_ctx, array, first, n);
 		}
-	private:
-		static inline Bag<T,Params.InitialPackedSize>			_comps;
-		static inline Bag<index_type,Params.InitialEntities>	_entToComp;
-		static inline Bag<ent_type,Params.InitialPackedSize>	_compToEnt;
 
-		static inline StorageCallbacks callbacks{del};
+		void attach(Sink sink, void* ctx) { _sink = sink; _ctx = ctx; }
+		size_type arrays() const { return _count; }
+		const Array& array(index_type i) const { return _arrays[i]; }
+	private:
+		template <class B> static unsigned char* bagData(void* b) {
+			return reinterpret_cast<unsigned char*>(static_cast<B*>(b)->data());
+		}
+		template <class B> static size_type bagSize(void* b) { return static_cast<B*>(b)->size(); }
+		template <class B> static size_type bagCapacity(void* b) { return static_cast<B*>(b)->capacity(); }
+		template <class B> static void bagResize(void* b, size_type n) { static_cast<B*>(b)->resize(n); }
+		template <class B> static void bagEnsure(void* b, size_type n) { static_cast<B*>(b)->ensure(n); }
+		static unsigned char* valueData(void* v) { return static_cast<unsigned char*>(v); }
+		static size_type valueExtent(void*) { return 1; }
+		static void valueRestore(void*, size_type) {}
 
-		__attribute__((used))
-		static inline StorageRegister<T> reg{callbacks};
-	};
-	template <class T>
-	class TaggedStorage final : NoInstance
-	{
-	public:
-		static void add(ent_type, const T&) {}
-		static void del(ent_type) {}
-		static T& get(ent_type) = delete;
-	};
+		index_type track(const Array& a) {
+			if constexpr (!Params.TrackWrites)
+				return -1;
+			_arrays[_count] = a;
+			return _count++;
+		}
 
-	template <class T>
-	struct Storage final : NoInstance {
-		using type = SparseStorage<T>;
+		Array		_arrays[Capacity] = {};
+		size_type	_count = 0;
+		Sink		_sink = nullptr;
+		void*		_ctx = nullptr;
 	};
 
 	class SingleMask final
 	{
 	public:
 		using bit_type = mask_type;
-		static constexpr bit_type bit(index_type idx) { return 1<<idx; }
+		static constexpr bit_type bit(index_type idx) { return bit_type{1}<<idx; }
 
 		void set(const bit_type b) { _mask |= b; }
 
@@ -189,8 +328,9 @@ namespace bagel
 
 		bool test(const bit_type b) const { return _mask & b; }
 		bool test(const SingleMask m) const { return (_mask & m._mask) == m._mask; }
+		bool operator==(const SingleMask m) const { return _mask == m._mask; }
 
-		index_type ctz() const { return _mask ? __builtin_ctz(_mask) : -1; }
+		index_type ctz() const { return _mask ? __builtin_ctzll(_mask) : -1; }
 	private:
 		mask_type	_mask{0};
 	};
@@ -202,7 +342,7 @@ namespace bagel
 			const mask_type		mask;
 		};
 		static constexpr bit_type bit(index_type idx) {
-			return {idx/BitsetWidth, static_cast<mask_type>(1<<(idx%BitsetWidth))};
+			return {idx/BitsetWidth, static_cast<mask_type>(mask_type{1}<<(idx%BitsetWidth))};
 		}
 
 		void set(const bit_type& b) { _masks[b.index] |= b.mask; }
@@ -217,82 +357,729 @@ namespace bagel
 					return false;
 			return true;
 		}
+		bool operator==(const MultiMask& m) const {
+			return memcmp(_masks, m._masks, sizeof(_masks)) == 0;
+		}
 
 		index_type ctz() const {
 			for (index_type i = 0; i < Size; ++i) {
 				if (_masks[i]) {
-					int c = __builtin_ctz(_masks[i]);
+					int c = __builtin_ctzll(_masks[i]);
 					return c + i*BitsetWidth;
 				}
 			}
 			return -1;
 		}
 	private:
-		static constexpr size_type	Size = (Params.MaxComponents-1)/BitsetWidth + 1;
+		static constexpr size_type	Size = (MaxComponents-1)/BitsetWidth + 1;
 		mask_type					_masks[Size] ={};
 	};
-	using Mask = std::conditional_t<Params.MaxComponents<=BitsetWidth, SingleMask, MultiMask>;
+	using Mask = std::conditional_t<MaxComponents<=BitsetWidth, SingleMask, MultiMask>;
+
+	// State of a storage (or of Archetypes) in the World bound to the calling thread,
+	// created on first use (see World::current).
+	template <class S> S& worldState(index_type slot);
+	template <class T> struct Component;
+
+	struct StorageCallbacks
+	{
+		using Destroy = void (*)(ent_type);
+		using Save = void (*)(SnapshotBlocks&);
+		using Load = void (*)(SnapshotBlocks&);
+		// Whether the storage's snapshot blocks agree with the masks (see World::load): the
+		// entities holding the component, and the highest id among them (-1 if none).
+		using Check = bool (*)(SnapshotBlocks&, const Mask* masks, size_type entities, size_type holders,
+			id_type last);
+		Destroy destroy = nullptr;
+		Save save = nullptr;
+		Load load = nullptr;
+		Check check = nullptr;
+	};
+	struct GroupHooks
+	{
+		using Added = void (*)(ent_type);
+		using Removing = void (*)(ent_type, index_type);
+		Added added = nullptr;
+		Removing removing = nullptr;
+	};
+	template <class> class StorageRegister;
+
+	template <class T>
+	class SparseStorage final : NoInstance
+	{
+	public:
+		static void add(ent_type e, const T& t) {
+			State& s = state();
+			s.bag.ensure(e.id+1);
+			s.journal.write(s.bagArr, e.id);
+			s.bag[e.id] = t;
+		}
+		static void del(ent_type) {}
+		// add() for n entities, value(i) giving the component of es[i].
+		template <class F>
+		static void addBatch(const ent_type* es, size_type n, F&& value) {
+			State& s = state();
+			id_type top = -1;
+			for (index_type i = 0; i < n; ++i)
+				top = std::max(top, es[i].id);
+			s.bag.ensure(top+1);
+			for (index_type i = 0; i < n; ++i) {
+				s.journal.write(s.bagArr, es[i].id);
+				s.bag[es[i].id] = value(i);
+			}
+		}
+		static void delBatch(const ent_type*, size_type) {}
+		static T& get(ent_type e) {
+			State& s = state();
+			s.journal.write(s.bagArr, e.id);
+			return s.bag[e.id];
+		}
+		static const T& read(ent_type e) { return state().bag[e.id]; }
+
+		static void save(SnapshotBlocks& b) {
+			State& s = state();
+			b.put(s.bag.data(), std::min(s.bag.capacity(), b.entities()));
+		}
+		static void load(SnapshotBlocks& b) { b.adopt(state().bag); }
+		static bool check(SnapshotBlocks& b, const Mask*, size_type entities, size_type, id_type last) {
+			size_type n;
+			b.take<T>(n);
+			return n <= entities && n > last;
+		}
+	private:
+		// The storage's arrays in one World.
+		struct State : NoCopy {
+			explicit State(Journal& j) : journal(j), bagArr(j.trackBag(bag, false)) {}
+
+			Bag<T,Params.InitialEntities>	bag;
+			Journal&						journal;
+			const index_type				bagArr;
+		};
+		static State& state() { return worldState<State>(Component<T>::Index); }
+
+		static inline StorageCallbacks callbacks{nullptr, save, load, check};
+
+		__attribute__((used))
+		static inline StorageRegister<T> reg{callbacks};
+	};
+	template <class T>
+	class PackedStorage final : NoInstance
+	{
+	public:
+		static void add(ent_type e, const T& t) {
+			State& s = state();
+			s.entToComp.ensure(e.id+1);
+			append(s, e, t);
+			if (_group.added != nullptr)
+				_group.added(e);
+		}
+		static void del(ent_type e) { remove(state(), e); }
+		// add() for n entities, value(i) giving the component of es[i]: the arrays grow
+		// once, then the rows are appended (and offered to the owning group) in order.
+		template <class F>
+		static void addBatch(const ent_type* es, size_type n, F&& value) {
+			State& s = state();
+			id_type top = -1;
+			for (index_type i = 0; i < n; ++i)
+				top = std::max(top, es[i].id);
+			s.entToComp.ensure(top+1);
+			s.comps.ensure(s.comps.size() + n);
+			s.compToEnt.ensure(s.compToEnt.size() + n);
+			for (index_type i = 0; i < n; ++i)
+				append(s, es[i], value(i));
+			if (_group.added != nullptr)
+				for (index_type i = 0; i < n; ++i)
+					_group.added(es[i]);
+		}
+		// del() for n entities, swap-removing their rows in one pass.
+		static void delBatch(const ent_type* es, size_type n) {
+			State& s = state();
+			for (index_type i = 0; i < n; ++i)
+				remove(s, es[i]);
+		}
+		static T& get(ent_type e) {
+			State& s = state();
+			s.journal.write(s.compsArr, s.entToComp[e.id]);
+			return s.comps[s.entToComp[e.id]];
+		}
+		static const T& read(ent_type e) {
+			State& s = state();
+			return s.comps[s.entToComp[e.id]];
+		}
+		static int size() { return state().comps.size(); }
+		static T& get(index_type idx) {
+			State& s = state();
+			s.journal.write(s.compsArr, idx);
+			return s.comps[idx];
+		}
+		static ent_type entity(index_type idx) {
+			return state().compToEnt[idx];
+		}
+		static index_type index(ent_type e) {
+			return state().entToComp[e.id];
+		}
+		static T* data() {
+			State& s = state();
+			s.journal.write(s.compsArr, 0, s.comps.size());
+			return &s.comps[0];
+		}
+
+		static void swap(index_type a, index_type b) {
+			if (a == b)
+				return;
+			State& s = state();
+			s.journal.write(s.compsArr, a);
+			s.journal.write(s.compsArr, b);
+			s.journal.write(s.compToEntArr, a);
+			s.journal.write(s.compToEntArr, b);
+			s.journal.write(s.entToCompArr, s.compToEnt[a].id);
+			s.journal.write(s.entToCompArr, s.compToEnt[b].id);
+			std::swap(s.comps[a], s.comps[b]);
+			std::swap(s.compToEnt[a], s.compToEnt[b]);
+			s.entToComp[s.compToEnt[a].id] = a;
+			s.entToComp[s.compToEnt[b].id] = b;
+		}
+		static void own(const GroupHooks& hooks) { _group = hooks; }
+		// Rows at the front kept by the owning group, if any (see Group).
+		static size_type grouped() { return state().grouped; }
+		static void setGrouped(size_type n) {
+			State& s = state();
+			s.journal.write(s.groupedArr, 0);
+			s.grouped = n;
+		}
+
+		static void save(SnapshotBlocks& b) {
+			State& s = state();
+			b.put(s.comps.data(), s.comps.size());
+			b.put(s.compToEnt.data(), s.compToEnt.size());
+			b.put(s.entToComp.data(), std::min(s.entToComp.capacity(), b.entities()));
+			b.put(&s.grouped, 1);
+		}
+		static void load(SnapshotBlocks& b) {
+			State& s = state();
+			b.adopt(s.comps);
+			b.adopt(s.compToEnt);
+			b.adopt(s.entToComp);
+			size_type n;
+			const size_type* grouped = b.take<size_type>(n);
+			s.grouped = n > 0 ? *grouped : 0;
+		}
+		// One row per holder, each row's entity holding T and mapped back to that row.
+		static bool check(SnapshotBlocks& b, const Mask* masks, size_type entities, size_type holders,
+				id_type last) {
+			size_type rows, ents, ids, n;
+			b.take<T>(rows);
+			const ent_type* compToEnt = b.take<ent_type>(ents);
+			const index_type* entToComp = b.take<index_type>(ids);
+			const size_type* grouped = b.take<size_type>(n);
+			if (rows != holders || ents != rows || ids > entities || ids <= last ||
+				n != 1 || *grouped < 0 || *grouped > rows)
+				return false;
+			for (index_type i = 0; i < rows; ++i) {
+				const id_type id = compToEnt[i].id;
+				if (id < 0 || id >= ids || !masks[id].test(Component<T>::Bit) || entToComp[id] != i)
+					return false;
+			}
+			return true;
+		}
+	private:
+		// The storage's arrays in one World.
+		struct State : NoCopy {
+			explicit State(Journal& j)
+				: journal(j), compsArr(j.trackBag(comps, true)), entToCompArr(j.trackBag(entToComp, false)),
+				  compToEntArr(j.trackBag(compToEnt, true)), groupedArr(j.trackValue(grouped)) {}
+
+			Bag<T,Params.InitialPackedSize,ColumnAlign>	comps;
+			Bag<index_type,Params.InitialEntities>		entToComp;
+			Bag<ent_type,Params.InitialPackedSize>		compToEnt;
+			size_type									grouped = 0;
+			Journal&									journal;
+			const index_type							compsArr;
+			const index_type							entToCompArr;
+			const index_type							compToEntArr;
+			const index_type							groupedArr;
+		};
+		static State& state() { return worldState<State>(Component<T>::Index); }
+
+		// entToComp must already cover e.id.
+		static void append(State& s, ent_type e, const T& t) {
+			s.journal.write(s.entToCompArr, e.id);
+			s.journal.write(s.compsArr, s.comps.size());
+			s.journal.write(s.compToEntArr, s.compToEnt.size());
+			s.entToComp[e.id] = s.comps.size();
+			s.comps.push(t);
+			s.compToEnt.push(e);
+		}
+		static void remove(State& s, ent_type e) {
+			if (_group.removing != nullptr)
+				_group.removing(e, s.entToComp[e.id]);
+			index_type ent_comp_idx = s.entToComp[e.id];
+			const index_type last = s.comps.size()-1;
+			s.journal.write(s.compsArr, ent_comp_idx);
+			s.journal.write(s.compsArr, last);
+			s.journal.write(s.compToEntArr, ent_comp_idx);
+			s.journal.write(s.compToEntArr, last);
+			s.journal.write(s.entToCompArr, s.compToEnt[last].id);
+			ent_type last_ent = s.compToEnt.pop();
+
+			s.comps[ent_comp_idx] = s.comps.pop();
+			s.compToEnt[ent_comp_idx] = last_ent;
+			s.entToComp[last_ent.id] = ent_comp_idx;
+		}
+
+		static inline GroupHooks _group{};
+		static inline StorageCallbacks callbacks{del, save, load, check};
+
+		__attribute__((used))
+		static inline StorageRegister<T> reg{callbacks};
+	};
+	template <class T>
+	class TaggedStorage final : NoInstance
+	{
+	public:
+		static void add(ent_type, const T&) {}
+		static void del(ent_type) {}
+		template <class F> static void addBatch(const ent_type*, size_type, F&&) {}
+		static void delBatch(const ent_type*, size_type) {}
+		static T& get(ent_type) = delete;
+		static const T& read(ent_type) = delete;
+	};
+
+	template <class T>
+	struct Storage final : NoInstance {
+		using type = SparseStorage<T>;
+	};
 
-	static inline index_type compCounter = -1;
-	template <class>
+	template <class, class = void> struct IsRegistered : std::false_type {};
+	template <class T>
+	struct IsRegistered<T, std::void_t<decltype(Storage<T>::Index)>> : std::true_type {};
+
+	static inline index_type compCounter = RegisteredComponents - 1;
+	template <class T>
+	constexpr index_type componentIndex() {
+		if constexpr (IsRegistered<T>::value)
+			return Storage<T>::Index;
+		else
+			return ++compCounter;
+	}
+
+	template <class T>
 	struct Component final : NoInstance
 	{
-		static inline const index_type		Index = ++compCounter;
+		static_assert(IsRegistered<T>::value || Params.MaxComponents > 0 || RegisteredComponents == 0,
+			"auto-sized Mask: declare the component with BAGEL_STORAGE in bagel_cfg.h");
+
+		static inline const index_type		Index = componentIndex<T>();
 		static inline const Mask::bit_type	Bit = Mask::bit(Index);
 	};
 
+	/**
+	 * Shared backend of ArchetypeStorage, one per World: entities with the same set of
+	 * archetype components live together in 16 KB chunks, one SoA column per component
+	 * plus an entity column. Adding or deleting a component moves the entity's row to
+	 * the matching archetype (components must be trivially copyable).
+	 */
+	class Archetypes final : NoCopy
+	{
+	public:
+		static constexpr size_type ChunkBytes = 16*1024;
+		static constexpr size_type ChunkAlign = 64;
+
+		struct Layout { size_type size; size_type align; };
+
+		class ChunkView
+		{
+		public:
+			ChunkView(const Archetypes* owner, index_type a, unsigned char* data, size_type count)
+				: _owner(owner), _arch(a), _data(data), _count(count) {}
+
+			size_type size() const { return _count; }
+			const Mask& signature() const { return _owner->_archs[_arch].signature; }
+			const ent_type* entities() const { return reinterpret_cast<const ent_type*>(_data); }
+			template <class T> T* column() const {
+				return reinterpret_cast<T*>(_data + _owner->column(_arch, Component<T>::Index)->offset);
+			}
+		private:
+			const Archetypes*	_owner;
+			index_type			_arch;
+			unsigned char*		_data;
+			size_type			_count;
+		};
+
+		explicit Archetypes(Journal&) {}
+		~Archetypes() {
+			for (index_type a = 0; a < _archs.size(); ++a) {
+				for (index_type c = 0; c < _archs[a].numChunks; ++c)
+					free(_archs[a].chunks[c]);
+				free(_archs[a].chunks);
+			}
+		}
+
+		// Archetypes of the World bound to the calling thread.
+		static Archetypes& current() { return worldState<Archetypes>(MaxComponents); }
+		static void removeEntity(ent_type e) { current().remove(e); }
+
+		void attach(ent_type e, index_type comp, Layout l) {
+			_layouts[comp] = l;
+			Mask sig = signature(e);
+			if (sig.test(Mask::bit(comp)))
+				return;
+			sig.set(Mask::bit(comp));
+			migrate(e, sig);
+		}
+		void detach(ent_type e, index_type comp) {
+			Mask sig = signature(e);
+			if (!sig.test(Mask::bit(comp)))
+				return;
+			sig.clear(Mask::bit(comp));
+			migrate(e, sig);
+		}
+		void remove(ent_type e) {
+			if (e.id >= _known || _where[e.id].arch < 0)
+				return;
+			removeRow(_where[e.id].arch, _where[e.id].row);
+			_where[e.id] = {-1, -1};
+		}
+		void* get(ent_type e, index_type comp) {
+			const Location& loc = _where[e.id];
+			return cell(loc.arch, column(loc.arch, comp), loc.row);
+		}
+
+		template <class F>
+		void forEachChunk(const Mask& include, F&& f) const {
+			for (index_type a = 0; a < _archs.size(); ++a) {
+				if (!_archs[a].signature.test(include))
+					continue;
+				const Archetype& arch = _archs[a];
+				for (index_type c = 0; c < arch.numChunks; ++c) {
+					size_type n = std::min(arch.rowsPerChunk, arch.count - c*arch.rowsPerChunk);
+					f(ChunkView{this, a, arch.chunks[c], n});
+				}
+			}
+		}
+		size_type archetypes() const { return _archs.size(); }
+		size_type rows() const {
+			size_type n = 0;
+			for (index_type a = 0; a < _archs.size(); ++a)
+				n += _archs[a].count;
+			return n;
+		}
+	private:
+		struct Column { index_type comp; size_type offset; size_type size; };
+		struct Location { index_type arch; index_type row; };
+		struct Archetype {
+			Mask			signature;
+			index_type		firstCol;
+			size_type		numCols;
+			size_type		rowsPerChunk;
+			size_type		chunkBytes;
+			size_type		count;
+			unsigned char**	chunks;
+			size_type		numChunks;
+		};
+
+		Mask signature(ent_type e) {
+			while (_known <= e.id) {
+				_where.ensure(_known+1);
+				_where[_known++] = {-1, -1};
+			}
+			index_type a = _where[e.id].arch;
+			return a < 0 ? Mask{} : _archs[a].signature;
+		}
+		void migrate(ent_type e, const Mask& sig) {
+			Location from = _where[e.id];
+			Location to{-1, -1};
+			if (sig.ctz() >= 0) {
+				to.arch = find(sig);
+				to.row = append(to.arch, e);
+				if (from.arch >= 0) {
+					const Archetype& dst = _archs[to.arch];
+					for (index_type i = dst.firstCol; i < dst.firstCol + dst.numCols; ++i) {
+						const Column* src = column(from.arch, _cols[i].comp);
+						if (src != nullptr)
+							memcpy(cell(to.arch, &_cols[i], to.row),
+								cell(from.arch, src, from.row), _cols[i].size);
+					}
+				}
+			}
+			if (from.arch >= 0)
+				removeRow(from.arch, from.row);
+			_where[e.id] = to;
+		}
+
+		index_type find(const Mask& sig) {
+			for (index_type a = 0; a < _archs.size(); ++a)
+				if (_archs[a].signature == sig)
+					return a;
+
+			Archetype arch{};
+			arch.signature = sig;
+			arch.firstCol = _cols.size();
+
+			size_type rowBytes = sizeof(ent_type), padding = 0;
+			Mask m = sig;
+			for (index_type c = m.ctz(); c >= 0; m.clear(Mask::bit(c)), c = m.ctz()) {
+				rowBytes += _layouts[c].size;
+				padding += _layouts[c].align;
+				++arch.numCols;
+			}
+			arch.rowsPerChunk = std::max(1, (ChunkBytes - padding) / rowBytes);
+
+			size_type offset = arch.rowsPerChunk * sizeof(ent_type);
+			m = sig;
+			for (index_type c = m.ctz(); c >= 0; m.clear(Mask::bit(c)), c = m.ctz()) {
+				offset = (offset + _layouts[c].align - 1) / _layouts[c].align * _layouts[c].align;
+				_cols.push({c, offset, _layouts[c].size});
+				offset += arch.rowsPerChunk * _layouts[c].size;
+			}
+			arch.chunkBytes = (std::max(offset, ChunkBytes) + ChunkAlign - 1) / ChunkAlign * ChunkAlign;
+
+			_archs.push(arch);
+			return _archs.size() - 1;
+		}
+
+		const Column* column(index_type a, index_type comp) const {
+			const Archetype& arch = _archs[a];
+			for (index_type i = arch.firstCol; i < arch.firstCol + arch.numCols; ++i)
+				if (_cols[i].comp == comp)
+					return &_cols[i];
+			return nullptr;
+		}
+		unsigned char* cell(index_type a, const Column* col, index_type row) const {
+			const Archetype& arch = _archs[a];
+			return arch.chunks[row / arch.rowsPerChunk]
+				+ col->offset + (row % arch.rowsPerChunk) * col->size;
+		}
+		ent_type& entityAt(index_type a, index_type row) {
+			const Archetype& arch = _archs[a];
+			return reinterpret_cast<ent_type*>(arch.chunks[row / arch.rowsPerChunk])
+				[row % arch.rowsPerChunk];
+		}
+
+		index_type append(index_type a, ent_type e) {
+			Archetype& arch = _archs[a];
+			if (arch.count == arch.numChunks * arch.rowsPerChunk) {
+				arch.chunks = static_cast<unsigned char**>(
+					realloc(arch.chunks, sizeof(unsigned char*) * (arch.numChunks+1)));
+				arch.chunks[arch.numChunks++] = static_cast<unsigned char*>(
+					aligned_alloc(ChunkAlign, arch.chunkBytes));
+			}
+			entityAt(a, arch.count) = e;
+			return arch.count++;
+		}
+		void removeRow(index_type a, index_type row) {
+			Archetype& arch = _archs[a];
+			index_type last = --arch.count;
+			if (row != last) {
+				for (index_type i = arch.firstCol; i < arch.firstCol + arch.numCols; ++i)
+					memcpy(cell(a, &_cols[i], row), cell(a, &_cols[i], last), _cols[i].size);
+				ent_type moved = entityAt(a, last);
+				entityAt(a, row) = moved;
+				_where[moved.id].row = row;
+			}
+			if (arch.count <= (arch.numChunks-1) * arch.rowsPerChunk)
+				free(arch.chunks[--arch.numChunks]);
+		}
+
+		Layout									_layouts[MaxComponents] = {};
+		DynamicBag<Archetype,64>				_archs;	// one per signature in use: no static bound
+		DynamicBag<Column,256>					_cols;
+		Bag<Location,Params.InitialEntities>	_where;
+		size_type								_known = 0;
+	};
+
+	template <class T>
+	class ArchetypeStorage final : NoInstance
+	{
+	public:
+		static void add(ent_type e, const T& t) {
+			Archetypes::current().attach(e, Component<T>::Index, layout());
+			if constexpr (!std::is_empty_v<T>)
+				get(e) = t;
+		}
+		static void del(ent_type e) { Archetypes::current().detach(e, Component<T>::Index); }
+		// Each entity migrates to its new archetype on its own.
+		template <class F>
+		static void addBatch(const ent_type* es, size_type n, F&& value) {
+			for (index_type i = 0; i < n; ++i)
+				add(es[i], value(i));
+		}
+		static void delBatch(const ent_type* es, size_type n) {
+			for (index_type i = 0; i < n; ++i)
+				del(es[i]);
+		}
+		static T& get(ent_type e) {
+			if constexpr (std::is_empty_v<T>) {
+				static T tag;
+				return tag;
+			}
+			else
+				return *static_cast<T*>(Archetypes::current().get(e, Component<T>::Index));
+		}
+		static const T& read(ent_type e) { return get(e); }
+	private:
+		static_assert(std::is_trivially_copyable_v<T>, "ArchetypeStorage moves rows with memcpy");
+		static constexpr Archetypes::Layout layout() {
+			return {std::is_empty_v<T> ? 0 : static_cast<size_type>(sizeof(T)),
+				static_cast<size_type>(alignof(T))};
+		}
+
+		// Chunks are not saved: a snapshot's entities cannot hold T.
+		static bool check(SnapshotBlocks&, const Mask*, size_type, size_type holders, id_type) {
+			return holders == 0;
+		}
+
+		static inline StorageCallbacks callbacks{Archetypes::removeEntity, nullptr, nullptr, check};
+
+		__attribute__((used))
+		static inline StorageRegister<T> reg{callbacks};
+	};
+
 	struct AddedMask {
 		Mask prev;
 		Mask next;
 		ent_type e;
 	};
 
-	class World final : NoInstance
+	class CommandBuffer;
+
+	/**
+	 * Entities, the states of their storages and the CommandBuffers replayed by step().
+	 * Several Worlds can live in one process, e.g. one independent simulation per thread:
+	 * the static API works on the World bound to the calling thread by a Bind scope, or
+	 * on a default World when none is. A World is used by one simulation at a time; its
+	 * CommandBuffers, other than the per-thread ones it creates, must not outlive it.
+	 * Component indices and storage callbacks are process-wide, shared by every World.
+	 */
+	class World final : NoCopy
 	{
 	public:
+		// Memory the World's arrays may use in place (a mapped snapshot), released with the
+		// World or when replaced.
+		struct Backing {
+			void*	data = nullptr;
+			size_t	bytes = 0;
+			void	(*release)(void*, size_t) = nullptr;
+		};
+
+		World()
+			: _maxIdArr(_journal.trackValue(_maxId)), _masksArr(_journal.trackBag(_masks, true)),
+			  _gensArr(_journal.trackBag(_gens, true)), _inactiveArr(_journal.trackBag(_inactive, true)),
+			  _idsArr(_journal.trackBag(_ids, true)) {}
+		~World();
+
+		// World of the calling thread: the innermost Bind, otherwise the default World.
+		static World& current() {
+			if (_bound != nullptr)
+				return *_bound;
+			static World* const world = new World; // never destroyed: threads may outlive main
+			return *world;
+		}
+		// Routes the static API of the calling thread to another World while in scope.
+		class Bind : NoCopy
+		{
+		public:
+			explicit Bind(World& w) : _prev(_bound) { _bound = &w; }
+			~Bind() { _bound = _prev; }
+		private:
+			World* _prev;
+		};
+
+		Journal& journal() { return _journal; }
+		void setBacking(const Backing& b) {
+			if (_backing.release != nullptr)
+				_backing.release(_backing.data, _backing.bytes);
+			_backing = b;
+		}
+
 		static ent_type createEntity() {
-			if (_ids.size() > 0)
-				return _ids.pop();
-			_masks.push(Mask{});
-			return {++_maxId.id};
+			World& w = current();
+			if (w._ids.size() > 0) {
+				w._journal.write(w._idsArr, w._ids.size()-1);
+				id_type id = w._ids.pop().id;
+				w._journal.write(w._gensArr, id);
+				return {id, ++w._gens[id]};
+			}
+			w._journal.write(w._masksArr, w._masks.size());
+			w._journal.write(w._gensArr, w._gens.size());
+			w._journal.write(w._inactiveArr, w._inactive.size());
+			w._journal.write(w._maxIdArr, 0);
+			w._masks.push(Mask{});
+			w._gens.push(0);
+			w._inactive.push(false);
+			return {++w._maxId.id, 0};
 		}
+		// Removes every component (through the storages' destroy callbacks) and frees the
+		// id for reuse under a new generation. Stale handles and free ids are ignored.
 		static void destroyEntity(ent_type ent) {
+			if (!isAlive(ent))
+				return;
+			World& w = current();
 			if constexpr (Params.CallbackOnDestroy) {
-				Mask m = _masks[ent.id];
+				Mask m = w._masks[ent.id];
 				int ctz = m.ctz(); // count-trailing-zeros
 				while (ctz >= 0) {
 					if (_callbacks[ctz].destroy != nullptr)
-						_callbacks->destroy(ent);
+						_callbacks[ctz].destroy(ent);
 					m.clear(Mask::bit(ctz));
 					ctz = m.ctz();
 				}
 			}
-			_masks[ent.id].clear();
-			_ids.push(ent);
+			w._journal.write(w._masksArr, ent.id);
+			w._journal.write(w._inactiveArr, ent.id);
+			w._journal.write(w._gensArr, ent.id);
+			w._journal.write(w._idsArr, w._ids.size());
+			w._masks[ent.id].clear();
+			w._inactive[ent.id] = false;
+			++w._gens[ent.id];		// odd: free until createEntity reuses it
+			w._ids.push(ent);
+		}
+		// Inactive entities keep their components but are skipped by views, so they can
+		// be parked and brought back without any structural change (see EntityPool).
+		static void setActive(ent_type e, bool active) {
+			World& w = current();
+			w._journal.write(w._inactiveArr, e.id);
+			w._inactive[e.id] = !active;
 		}
+		static bool isActive(ent_type e) { return !current()._inactive[e.id]; }
+		static bool isAlive(ent_type e) {
+			const World& w = current();
+			return e.id >= 0 && e.id <= w._maxId.id && w._gens[e.id] == e.gen && (e.gen & 1) == 0;
+		}
+		// Current handle of an id; not alive if the id is free.
+		static ent_type handle(id_type id) { return {id, current()._gens[id]}; }
 		static const Mask& mask(ent_type e) {
-			return _masks[e.id];
+			return current()._masks[e.id];
 		}
         static Mask& maskMutable(ent_type e) {
-            return _masks[e.id];
+            World& w = current();
+            w._journal.write(w._masksArr, e.id);
+            return w._masks[e.id];
         }
-        static ent_type maxId() { return _maxId; }
+        static ent_type maxId() { return current()._maxId; }
 
 		template <class T>
 		static T& getComponent(ent_type e) {
 			return Storage<T>::type::get(e);
 		}
+		// Read-only access: unlike getComponent, never reported to Journal as a write.
+		template <class T>
+		static const T& readComponent(ent_type e) {
+			return Storage<T>::type::read(e);
+		}
 
 		template <class T>
 		static void addComponent(ent_type e, const T& t) {
-			Mask prev = _masks[e.id];
+			World& w = current();
+			Mask prev = w._masks[e.id];
 
-			_masks[e.id].set(Component<T>::Bit);
+			w._journal.write(w._masksArr, e.id);
+			w._masks[e.id].set(Component<T>::Bit);
 			Storage<T>::type::add(e,t);
 
 			if constexpr (Params.AggregateUpdates) {
-				Mask next = _masks[e.id];
-				_added.push({prev,next,e});
+				Mask next = w._masks[e.id];
+				w._added.push({prev,next,e});
 			}
 		}
 		template <class T, class...Ts>
@@ -304,7 +1091,9 @@ namespace bagel
 
 		template <class T>
 		static void delComponent(ent_type e) {
-			_masks[e.id].clear(Component<T>::Bit);
+			World& w = current();
+			w._journal.write(w._masksArr, e.id);
+			w._masks[e.id].clear(Component<T>::Bit);
 			Storage<T>::type::del(e);
 		}
 		template <class T, class ...Ts>
@@ -314,22 +1103,208 @@ namespace bagel
 				delComponents<Ts...>(e);
 		}
 
+		// addComponent<T> for n distinct entities lacking T, value(i) giving the component
+		// of es[i]; the storage reserves room for all of them at once (CommandBuffer::flush).
+		template <class T, class F>
+		static void addBatch(const ent_type* es, size_type n, F&& value) {
+			World& w = current();
+			for (index_type i = 0; i < n; ++i) {
+				Mask prev = w._masks[es[i].id];
+				w._journal.write(w._masksArr, es[i].id);
+				w._masks[es[i].id].set(Component<T>::Bit);
+				if constexpr (Params.AggregateUpdates)
+					w._added.push({prev,w._masks[es[i].id],es[i]});
+			}
+			Storage<T>::type::addBatch(es, n, value);
+		}
+		// delComponent<T> for n distinct entities holding T.
+		template <class T>
+		static void delBatch(const ent_type* es, size_type n) {
+			World& w = current();
+			for (index_type i = 0; i < n; ++i) {
+				w._journal.write(w._masksArr, es[i].id);
+				w._masks[es[i].id].clear(Component<T>::Bit);
+			}
+			Storage<T>::type::delBatch(es, n);
+		}
+
 		template <class T>
 		static void registerStorage(StorageCallbacks& cb) {
 			_callbacks[Component<T>::Index] = cb;
 		}
 
-		static size_type sizeAdded() { return _added.size(); }
-		static const AddedMask& getAdded(int i) { return _added[i]; }
+		static size_type sizeAdded() { return current()._added.size(); }
+		static const AddedMask& getAdded(int i) { return current()._added[i]; }
 
-		static void step() { _added.clear(); }
+		// Records every entity and the arrays of every storage with snapshot hooks (see
+		// bagel_snapshot.h). False while ArchetypeStorage holds rows: chunks are not captured.
+		static bool save(SnapshotBlocks& b) {
+			if (Archetypes::current().rows() > 0)
+				return false;
+			World& w = current();
+			const size_type n = w._maxId.id + 1;
+			b.setEntities(n);
+			b.begin(-1);
+			b.put(&w._maxId, 1);
+			b.put(w._masks.data(), n);
+			b.put(w._gens.data(), n);
+			b.put(w._inactive.data(), n);
+			b.put(w._ids.data(), w._ids.size());
+			for (index_type c = 0; c < MaxComponents; ++c) {
+				if (_callbacks[c].save == nullptr)
+					continue;
+				b.begin(c);
+				_callbacks[c].save(b);
+			}
+			return true;
+		}
+		// Replaces every entity and storage with a snapshot, adopting its arrays in place.
+		// Nothing changes if the blocks are not laid out as save() lays them out in this
+		// build, or if their counts disagree (see check()). Call it between steps.
+		static bool load(SnapshotBlocks& b) {
+			SnapshotBlocks expected;
+			if (!save(expected) || !b.sameLayout(expected) || !check(b))
+				return false;
+			World& w = current();
+			size_type n;
+			b.rewind();
+			b.begin(-1);
+			w._maxId = *b.take<ent_type>(n);
+			b.adopt(w._masks);
+			b.adopt(w._gens);
+			b.adopt(w._inactive);
+			b.adopt(w._ids);
+			for (index_type c = 0; c < MaxComponents; ++c) {
+				if (_callbacks[c].load == nullptr)
+					continue;
+				b.begin(c);
+				_callbacks[c].load(b);
+			}
+			w._added.clear();
+			return true;
+		}
+
+		static void step();
 	private:
-		static inline StorageCallbacks _callbacks[Params.MaxComponents] = {nullptr};
-		static inline Bag<AddedMask,Params.IdBagSize>		_added;
+		friend class CommandBuffer;
+
+		// Whether the counts of a snapshot's blocks agree, so that no access of the loaded
+		// World leaves its arrays: one maxId, per-id arrays of maxId+1 elements, free ids in
+		// range and free, and storages agreeing with the masks. One pass over the masks,
+		// then one over the rows of every storage.
+		static bool check(SnapshotBlocks& b) {
+			size_type n, masks, gens, inactive, free;
+			b.rewind();
+			b.begin(-1);
+			const ent_type* maxId = b.take<ent_type>(n);
+			if (n != 1 || maxId->id < -1)
+				return false;
+			const size_type entities = maxId->id + 1;
+			const Mask* m = b.take<Mask>(masks);
+			const id_type* g = b.take<id_type>(gens);
+			b.take<bool>(inactive);
+			const ent_type* ids = b.take<ent_type>(free);
+			if (masks != entities || gens != entities || inactive != entities || free > entities)
+				return false;
+			for (index_type i = 0; i < free; ++i)
+				if (ids[i].id < 0 || ids[i].id >= entities || (g[ids[i].id] & 1) == 0)
+					return false;
+
+			size_type holders[MaxComponents] = {};
+			id_type last[MaxComponents];
+			std::fill(last, last + MaxComponents, -1);
+			for (id_type id = 0; id < entities; ++id) {
+				Mask k = m[id];
+				for (index_type c = k.ctz(); c >= 0; k.clear(Mask::bit(c)), c = k.ctz()) {
+					if (c >= MaxComponents)
+						return false;
+					++holders[c];
+					last[c] = id;
+				}
+			}
+			for (index_type c = 0; c < MaxComponents; ++c) {
+				if (_callbacks[c].check == nullptr)
+					continue;
+				b.begin(c);
+				if (!_callbacks[c].check(b, m, entities, holders[c], last[c]))
+					return false;
+			}
+			return true;
+		}
+		template <class S> friend S& worldState(index_type);
+
+		// Per-thread CommandBuffers, by threadSlot(): MaxThreads per block, and one more block
+		// chained for every further MaxThreads threads alive at the same time.
+		static constexpr size_type MaxThreads = 256;
+		struct LocalBlock {
+			CommandBuffer*				buffers[MaxThreads] = {};
+			std::atomic<LocalBlock*>	next{nullptr};
+		};
+
+		// A storage's (or Archetypes') state, created by the first thread to use it.
+		struct Slot {
+			std::atomic<void*>	state{nullptr};
+			void				(*release)(void*) = nullptr;
+		};
+		template <class S>
+		void* createState(index_type slot) {
+			std::lock_guard<std::mutex> lock(_stateMutex);
+			void* s = _slots[slot].state.load(std::memory_order_relaxed);
+			if (s == nullptr) {
+				s = new S(_journal);
+				_slots[slot].release = releaseState<S>;
+				_slots[slot].state.store(s, std::memory_order_release);
+			}
+			return s;
+		}
+		template <class S>
+		static void releaseState(void* s) { delete static_cast<S*>(s); }
+
+		// Index of the calling thread among the live threads, recycled when a thread exits.
+		static index_type threadSlot() {
+			struct Holder {
+				Holder() {
+					std::lock_guard<std::mutex> lock(_threadMutex);
+					slot = _freeThreads.size() > 0 ? _freeThreads.pop() : _threadCount++;
+				}
+				~Holder() {
+					std::lock_guard<std::mutex> lock(_threadMutex);
+					_freeThreads.push(slot);
+				}
+				index_type slot;
+			};
+			thread_local Holder holder;
+			return holder.slot;
+		}
+		CommandBuffer& localBuffer();
 
-		static inline ent_type								_maxId{-1};
-		static inline Bag<Mask,		Params.InitialEntities> _masks;
-		static inline Bag<ent_type,	Params.IdBagSize>		_ids;
+		Journal											_journal;
+		Bag<AddedMask,Params.IdBagSize>					_added;
+
+		ent_type										_maxId{-1};
+		Bag<Mask,		Params.InitialEntities>				_masks;
+		Bag<id_type,	Params.InitialEntities>				_gens;		// odd: free id
+		Bag<bool,		Params.InitialEntities>				_inactive;
+		Bag<ent_type,	Params.IdBagSize>					_ids;
+
+		const index_type								_maxIdArr;
+		const index_type								_masksArr;
+		const index_type								_gensArr;
+		const index_type								_inactiveArr;
+		const index_type								_idsArr;
+
+		Slot											_slots[MaxComponents+1];	// last: Archetypes
+		std::mutex										_stateMutex;
+		Bag<CommandBuffer*,64>							_registry;
+		std::mutex										_registryMutex;
+		LocalBlock										_local;
+		Backing											_backing;
+
+		static inline StorageCallbacks _callbacks[MaxComponents] = {nullptr};
+		static inline thread_local World*					_bound = nullptr;
+		static inline DynamicBag<index_type,MaxThreads>	_freeThreads;
+		static inline size_type							_threadCount = 0;
+		static inline std::mutex							_threadMutex;
 	};
 
 	template <class T>
@@ -341,6 +1316,310 @@ namespace bagel
 		}
 	};
 
+	/**
+	 * Records structural changes (create/destroy/add/del) into a linear arena and
+	 * replays them in one batch: all buffers are flushed by World::step().
+	 * Replay creates entities first, then applies add/del grouped by component type
+	 * (in recording order within a type), then activate/deactivate, then destroys.
+	 * Consecutive adds (or dels) of a type reach its storage as one batch, in id order.
+	 * add() replaces the value when the entity already has the component; del() and
+	 * destroy() of something already gone, and commands on stale handles, are ignored.
+	 */
+	class CommandBuffer : NoCopy
+	{
+	public:
+		// Registers the buffer for the step() of a World, by default the calling thread's.
+		explicit CommandBuffer(World& world = World::current()) : _world(&world) {
+			std::lock_guard<std::mutex> lock(world._registryMutex);
+			world._registry.push(this);
+		}
+		~CommandBuffer() {
+			Bag<CommandBuffer*,64>& registry = _world->_registry;
+			std::lock_guard<std::mutex> lock(_world->_registryMutex);
+			// Keep registration order: flushAll() replays buffers in that order
+			index_type i = 0;
+			while (i < registry.size() && registry[i] != this)
+				++i;
+			for (; i+1 < registry.size(); ++i)
+				registry[i] = registry[i+1];
+			registry.pop();
+			free(_arena);
+		}
+
+		// The returned placeholder can be passed to add/del/destroy of the same buffer.
+		ent_type create() {
+			record(Create, -1, {}, 0, nullptr);
+			return {-2 - _creates++};
+		}
+		void destroy(ent_type e) { record(Destroy, -1, e, 0, nullptr); }
+
+		template <class T>
+		void add(ent_type e, const T& t) {
+			static_assert(std::is_trivially_copyable_v<T>, "commands copy components with memcpy");
+			constexpr size_type bytes = std::is_empty_v<T> ? 0 : sizeof(T);
+			void* payload = record(Add, Component<T>::Index, e, bytes, applyRun<T>);
+			if constexpr (bytes > 0)
+				memcpy(payload, &t, bytes);
+		}
+		template <class T, class...Ts>
+		void addAll(ent_type e, const T& t, const Ts&... ts) {
+			add(e, t);
+			if constexpr (sizeof...(Ts)>0)
+				addAll(e, ts...);
+		}
+		template <class T>
+		void del(ent_type e) { record(Del, Component<T>::Index, e, 0, applyRun<T>); }
+		// World::setActive on replay; sorted after every component type.
+		void activate(ent_type e) { record(Activate, MaxComponents, e, 0, applyToggles); }
+		void deactivate(ent_type e) { record(Deactivate, MaxComponents, e, 0, applyToggles); }
+
+		size_type size() const { return _count; }
+		void flush();
+
+		// Buffer bound by a Bind scope, otherwise the calling thread's buffer in its
+		// World, replayed by World::step(). Commands still pending when the thread exits
+		// are replayed by the next step().
+		static CommandBuffer& local() {
+			return _bound ? *_bound : World::current().localBuffer();
+		}
+		// Routes local() of the calling thread to another buffer while in scope.
+		class Bind : NoCopy
+		{
+		public:
+			explicit Bind(CommandBuffer& b) : _prev(_bound) { _bound = &b; }
+			~Bind() { _bound = _prev; }
+		private:
+			CommandBuffer* _prev;
+		};
+		// Flushes every buffer of the calling thread's World.
+		static void flushAll() {
+			World& w = World::current();
+			std::lock_guard<std::mutex> lock(w._registryMutex);
+			for (index_type i = 0; i < w._registry.size(); ++i)
+				w._registry[i]->flush();
+		}
+	private:
+		enum Kind : unsigned char { Create, Add, Del, Activate, Deactivate, Destroy };
+		struct Ref;
+		// Applies the sorted records of one component type (or every toggle).
+		using Apply = void (*)(CommandBuffer&, const Ref*, size_type);
+
+		struct Header {
+			Apply		apply;
+			ent_type	e;
+			index_type	comp;
+			size_type	seq;
+			size_type	bytes;
+			Kind		kind;
+		};
+		struct Ref {
+			index_type	comp;
+			size_type	seq;
+			size_type	offset;
+			bool operator<(const Ref& o) const {
+				return comp != o.comp ? comp < o.comp : seq < o.seq;
+			}
+		};
+		// A record of a batch: the arena offset follows recording order.
+		struct Pending {
+			ent_type	e;
+			size_type	offset;
+			bool operator<(const Pending& o) const {
+				return e.id != o.e.id ? e.id < o.e.id : offset < o.offset;
+			}
+		};
+		static constexpr size_type RecordAlign = alignof(std::max_align_t);
+		static constexpr size_type HeaderBytes =
+			(sizeof(Header) + RecordAlign-1) / RecordAlign * RecordAlign;
+
+		void* record(Kind kind, index_type comp, ent_type e, size_type bytes, Apply apply) {
+			size_type total = HeaderBytes + (bytes + RecordAlign-1) / RecordAlign * RecordAlign;
+			if (_used + total > _capacity) {
+				_capacity = std::max(_capacity*2, _used + total);
+				_arena = static_cast<unsigned char*>(realloc(_arena, _capacity));
+			}
+			Header* h = reinterpret_cast<Header*>(_arena + _used);
+			*h = {apply, e, comp, _count++, bytes, kind};
+			_used += total;
+			return _arena + _used - total + HeaderBytes;
+		}
+		const Header& header(size_type offset) const {
+			return *reinterpret_cast<const Header*>(_arena + offset);
+		}
+		ent_type resolve(ent_type e) const {
+			return e.id <= -2 ? _created[-2 - e.id] : e;
+		}
+
+		template <class T>
+		T payload(size_type offset) const {
+			T t{};
+			if constexpr (!std::is_empty_v<T>)
+				memcpy(&t, _arena + offset + HeaderBytes, sizeof(T));
+			return t;
+		}
+
+		// Splits the run into stretches of adds and of dels. A stretch of adds batches the
+		// entities lacking T, an entity added twice keeping the last value, and then
+		// overwrites the values of those that already had it, in recording order.
+		template <class T>
+		static void applyRun(CommandBuffer& b, const Ref* refs, size_type n) {
+			for (index_type i = 0; i < n;) {
+				const Kind kind = b.header(refs[i].offset).kind;
+				b._batch.clear();
+				b._replaced.clear();
+				for (; i < n && b.header(refs[i].offset).kind == kind; ++i) {
+					const ent_type e = b.resolve(b.header(refs[i].offset).e);
+					if (!World::isAlive(e))
+						continue;
+					const bool has = World::mask(e).test(Component<T>::Bit);
+					if (has == (kind == Del))
+						b._batch.push({e, refs[i].offset});
+					else if (kind == Add)
+						b._replaced.push({e, refs[i].offset});
+				}
+				const size_type count = b.unique();
+				if (kind == Add) {
+					World::addBatch<T>(b._batchEnts.data(), count, [&b](index_type k) {
+						return b.payload<T>(b._batch[k].offset);
+					});
+					if constexpr (!std::is_empty_v<T>)
+						for (index_type k = 0; k < b._replaced.size(); ++k)
+							World::getComponent<T>(b._replaced[k].e) = b.payload<T>(b._replaced[k].offset);
+				}
+				else
+					World::delBatch<T>(b._batchEnts.data(), count);
+			}
+		}
+		static void applyToggles(CommandBuffer& b, const Ref* refs, size_type n) {
+			for (index_type i = 0; i < n; ++i) {
+				const Header& h = b.header(refs[i].offset);
+				const ent_type e = b.resolve(h.e);
+				if (World::isAlive(e))
+					World::setActive(e, h.kind == Activate);
+			}
+		}
+		// Sorts _batch by id, keeps the last record of each entity and lists the
+		// entities in _batchEnts; returns how many.
+		size_type unique() {
+			_batchEnts.clear();
+			if (_batch.size() == 0)
+				return 0;
+			std::sort(&_batch[0], &_batch[0] + _batch.size());
+			index_type kept = 0;
+			for (index_type i = 0; i < _batch.size(); ++i) {
+				if (i+1 < _batch.size() && _batch[i+1].e.id == _batch[i].e.id)
+					continue;
+				_batch[kept++] = _batch[i];
+				_batchEnts.push(_batch[i].e);
+			}
+			return kept;
+		}
+
+		unsigned char*	_arena = nullptr;
+		size_type		_used = 0;
+		size_type		_capacity = 0;
+		size_type		_count = 0;
+		size_type		_creates = 0;
+
+		Bag<ent_type,Params.IdBagSize>		_created;
+		Bag<Ref,Params.IdBagSize>			_structural;
+		Bag<ent_type,Params.IdBagSize>		_destroyed;
+		Bag<Pending,Params.IdBagSize>		_batch;
+		Bag<Pending,Params.IdBagSize>		_replaced;
+		Bag<ent_type,Params.IdBagSize>		_batchEnts;
+
+		World*							_world;
+
+		static inline thread_local CommandBuffer*	_bound = nullptr;
+	};
+
+	inline void CommandBuffer::flush() {
+		if (_count == 0)
+			return;
+		World::Bind bind(*_world);
+
+		_created.clear();
+		_structural.clear();
+		_destroyed.clear();
+		for (size_type offset = 0; offset < _used;) {
+			const Header& h = header(offset);
+			if (h.kind == Create)
+				_created.push(World::createEntity());
+			else if (h.kind == Destroy)
+				_destroyed.push(h.e);
+			else
+				_structural.push({h.comp, h.seq, offset});
+			offset += HeaderBytes + (h.bytes + RecordAlign-1) / RecordAlign * RecordAlign;
+		}
+
+		// One run per component type, in recording order within the type
+		std::sort(&_structural[0], &_structural[0] + _structural.size());
+		for (index_type i = 0; i < _structural.size();) {
+			index_type end = i+1;
+			while (end < _structural.size() && _structural[end].comp == _structural[i].comp)
+				++end;
+			header(_structural[i].offset).apply(*this, &_structural[i], end - i);
+			i = end;
+		}
+
+		// Repeated destroys are no-ops: the first one retires the handle
+		for (index_type i = 0; i < _destroyed.size(); ++i)
+			World::destroyEntity(resolve(_destroyed[i]));
+
+		_used = 0;
+		_count = 0;
+		_creates = 0;
+	}
+
+	inline World::~World() {
+		for (LocalBlock* b = &_local; b != nullptr;) {
+			for (index_type i = 0; i < MaxThreads; ++i)
+				delete b->buffers[i];
+			LocalBlock* next = b->next.load(std::memory_order_relaxed);
+			if (b != &_local)
+				delete b;
+			b = next;
+		}
+		for (index_type i = 0; i <= MaxComponents; ++i)
+			if (_slots[i].release != nullptr)
+				_slots[i].release(_slots[i].state.load(std::memory_order_relaxed));
+		setBacking({});
+	}
+	inline CommandBuffer& World::localBuffer() {
+		index_type slot = threadSlot();
+		LocalBlock* block = &_local;
+		for (; slot >= MaxThreads; slot -= MaxThreads) {
+			LocalBlock* next = block->next.load(std::memory_order_acquire);
+			if (next == nullptr) {
+				std::lock_guard<std::mutex> lock(_stateMutex);
+				next = block->next.load(std::memory_order_relaxed);
+				if (next == nullptr) {
+					next = new LocalBlock;
+					block->next.store(next, std::memory_order_release);
+				}
+			}
+			block = next;
+		}
+		CommandBuffer*& buffer = block->buffers[slot];
+		if (buffer == nullptr)
+			buffer = new CommandBuffer(*this);
+		return *buffer;
+	}
+
+	inline void World::step() {
+		current()._added.clear();
+		CommandBuffer::flushAll();
+	}
+
+	template <class S>
+	S& worldState(index_type slot) {
+		World& w = World::current();
+		void* s = w._slots[slot].state.load(std::memory_order_acquire);
+		if (s == nullptr)
+			s = w.createState<S>(slot);
+		return *static_cast<S*>(s);
+	}
+
 	class Entity
 	{
 	public:
@@ -349,6 +1628,7 @@ namespace bagel
 
 		static Entity create() { return World::createEntity(); }
 		void destroy() const { World::destroyEntity(_ent); }
+		bool alive() const { return World::isAlive(_ent); }
 
 		const Mask& mask() const { return World::mask(_ent); }
 
@@ -385,4 +1665,232 @@ namespace bagel
 	private:
 		Mask m;
 	};
-}
+
+	template <class...> struct Include {};
+	template <class...> struct Exclude {};
+
+	template <class> struct IsPacked : std::false_type {};
+	template <class T> struct IsPacked<PackedStorage<T>> : std::true_type {};
+	template <class> struct IsArchetype : std::false_type {};
+	template <class T> struct IsArchetype<ArchetypeStorage<T>> : std::true_type {};
+
+	/**
+	 * Iterates active entities having every Include component and none of the Exclude ones.
+	 * The smallest PackedStorage among the Include components drives iteration and only
+	 * its entities are mask-checked; with no packed component, ids 0..maxId are scanned.
+	 * The driver is walked back-to-front, so the current entity may delete a component
+	 * of the driver storage, and entities added during iteration are not visited.
+	 */
+	template <class, class = Exclude<>> class View;
+	template <class ...Ts, class ...Xs>
+	class View<Include<Ts...>, Exclude<Xs...>> final
+	{
+	public:
+		View() {
+			(_include.set(Component<Ts>::Bit), ...);
+			(pickDriver<Ts>(), ...);
+		}
+
+		class iterator
+		{
+		public:
+			iterator(const View* v, index_type i) : _view(v), _idx(i) { skip(); }
+
+			ent_type operator*() const { return _view->_entity(_idx); }
+			iterator& operator++() {
+				_idx = std::min(_idx-1, _view->_size()-1);
+				skip();
+				return *this;
+			}
+			bool operator!=(const iterator& o) const { return _idx != o._idx; }
+		private:
+			void skip() {
+				while (_idx >= 0 && !_view->match(_view->_entity(_idx)))
+					--_idx;
+			}
+
+			const View*	_view;
+			index_type	_idx;
+		};
+
+		iterator begin() const { return {this, _size()-1}; }
+		iterator end() const { return {this, -1}; }
+
+		template <class F>
+		void each(F&& f) const {
+			for (ent_type e : *this)
+				f(e);
+		}
+
+		// Chunk-by-chunk iteration when every component of the query is archetype-stored:
+		// f(count, entities, columns...) gets one contiguous column per Include component.
+		// Like match(), inactive entities are skipped: a chunk holding some is handed over
+		// as the runs of active rows between them.
+		template <class F>
+		void eachChunk(F&& f) const {
+			static_assert((IsArchetype<typename Storage<Ts>::type>::value && ...)
+				&& (IsArchetype<typename Storage<Xs>::type>::value && ...),
+				"eachChunk requires ArchetypeStorage components");
+			Archetypes::current().forEachChunk(_include, [&](const Archetypes::ChunkView& c) {
+				if ((c.signature().test(Component<Xs>::Bit) || ...))
+					return;
+				const ent_type* ents = c.entities();
+				index_type run = 0;
+				for (index_type i = 0; i <= c.size(); ++i) {
+					if (i < c.size() && World::isActive(ents[i]))
+						continue;
+					if (i > run)
+						f(i - run, ents + run, c.template column<Ts>() + run...);
+					run = i+1;
+				}
+			});
+		}
+
+		bool match(ent_type e) const {
+			const Mask& m = World::mask(e);
+			return m.test(_include) && (!m.test(Component<Xs>::Bit) && ...) && World::isActive(e);
+		}
+		size_type candidates() const { return _size(); }
+	private:
+		template <class T>
+		void pickDriver() {
+			using S = typename Storage<T>::type;
+			if constexpr (IsPacked<S>::value) {
+				if (!_packed || S::size() < _size()) {
+					_size = S::size;
+					_entity = S::entity;
+					_packed = true;
+				}
+			}
+		}
+
+		static size_type scanSize() { return World::maxId().id + 1; }
+		static ent_type scanEntity(index_type idx) { return World::handle(idx); }
+
+		Mask					_include;
+		size_type				(*_size)() = scanSize;
+		ent_type				(*_entity)(index_type) = scanEntity;
+		bool					_packed = false;
+	};
+
+	/**
+	 * Owning group: keeps the entities having all of Ts at the front of every owned
+	 * PackedStorage, in the same order, so row i of each storage belongs to entity(i).
+	 * Inactive entities stay in the group.
+	 * A storage can be owned by one group only.
+	 */
+	template <class ...Ts>
+	class Group final : NoInstance
+	{
+		static_assert((IsPacked<typename Storage<Ts>::type>::value && ...),
+			"groups own PackedStorage components");
+		using First = typename Storage<std::tuple_element_t<0, std::tuple<Ts...>>>::type;
+	public:
+		static size_type size() { return First::grouped(); }
+		static ent_type entity(index_type idx) { return First::entity(idx); }
+		template <class T> static T* data() { return Storage<T>::type::data(); }
+	private:
+		static void added(ent_type e) {
+			Mask all;
+			(all.set(Component<Ts>::Bit), ...);
+			if (!World::mask(e).test(all))
+				return;
+			const size_type n = size();
+			(Storage<Ts>::type::swap(Storage<Ts>::type::index(e), n), ...);
+			(Storage<Ts>::type::setGrouped(n+1), ...);
+		}
+		static void removing(ent_type e, index_type idx) {
+			if (idx >= size())
+				return;
+			const size_type n = size()-1;
+			(Storage<Ts>::type::setGrouped(n), ...);
+			(Storage<Ts>::type::swap(Storage<Ts>::type::index(e), n), ...);
+		}
+
+		struct Register {
+			Register() { (Storage<Ts>::type::own({added, removing}), ...); }
+		};
+
+		__attribute__((used))
+		static inline Register reg{};
+	};
+
+	/**
+	 * Warm set of prebuilt entities for things spawned and retired at a high rate
+	 * (bullets). Entities are built once and then only switched active/inactive
+	 * through a CommandBuffer, so acquire/release make no structural change.
+	 * acquire() and release() may be called from any thread. A released entity is
+	 * handed out again only once its deactivation was replayed by World::step().
+	 */
+	class EntityPool : NoCopy
+	{
+	public:
+		// Builds one entity with every component the pooled entities need.
+		using Build = ent_type (*)();
+
+		explicit EntityPool(Build build) : _build(build) {}
+
+		// Builds inactive entities until n are available. Structural: call it between steps.
+		void reserve(size_type n) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			while (_free.size() < n) {
+				ent_type e = _build();
+				World::setActive(e, false);
+				_free.push(e);
+			}
+		}
+
+		// An inactive entity whose activation is recorded in cmd, or id -1 if none is left.
+		ent_type acquire(CommandBuffer& cmd) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (_free.size() == 0)
+				reclaim();
+			if (_free.size() == 0)
+				return {-1};
+			ent_type e = _free.pop();
+			cmd.activate(e);
+			return e;
+		}
+		// Records the deactivation of e, which then returns to the pool. Works for
+		// entities not built by the pool as well, which grows it.
+		void release(CommandBuffer& cmd, ent_type e) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			cmd.deactivate(e);
+			_retired.push(e);
+		}
+
+		// Forgets every entity, for when the World was replaced (World::load).
+		void clear() {
+			std::lock_guard<std::mutex> lock(_mutex);
+			_free.clear();
+			_retired.clear();
+		}
+		// Adds an inactive entity built elsewhere, e.g. restored from a snapshot.
+		void adopt(ent_type e) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			_free.push(e);
+		}
+
+		size_type available() const { return _free.size(); }
+	private:
+		void reclaim() {
+			for (index_type i = 0; i < _retired.size();) {
+				ent_type e = _retired[i];
+				if (!World::isAlive(e)) {
+					_retired[i] = _retired.pop();
+				}
+				else if (!World::isActive(e)) {
+					_free.push(e);
+					_retired[i] = _retired.pop();
+				}
+				else
+					++i;
+			}
+		}
+
+		Build				_build;
+		Bag<ent_type,64>	_free;
+		Bag<ent_type,64>	_retired;
+		std::mutex			_mutex;
+	};
+}
\ No newline at end of file
@@ -4,7 +4,10 @@
 
 
 constexpr Bagel Params{
-	.DynamicResize = true
+	.DynamicResize = true,
+#ifdef BAGEL_REWIND
+	.TrackWrites = true,
+#endif
 };
 
 BAGEL_STORAGE(breakout::Position, PackedStorage)
@@ -20,7 +23,17 @@ BAGEL_STORAGE(breakout::Sprite, SparseStorage)
 BAGEL_STORAGE(breakout::BrickHealth, SparseStorage)
 BAGEL_STORAGE(breakout::LaserTag, TaggedStorage)
 BAGEL_STORAGE(breakout::StarPowerTag, TaggedStorage)
+BAGEL_STORAGE(breakout::HeartPowerTag, TaggedStorage)
 BAGEL_STORAGE(breakout::PhysicsBody, SparseStorage)
+BAGEL_STORAGE(breakout::BreakAnimation, PackedStorage)
+BAGEL_STORAGE(breakout::LatticeTag, TaggedStorage)
+BAGEL_STORAGE(breakout::PrevPosition, PackedStorage)
+
+#ifdef BAGEL_BENCH
+// Only the bagel_bench target defines it: no game component uses ArchetypeStorage
+struct BenchArchetype { float x, y; };
+BAGEL_STORAGE(BenchArchetype, ArchetypeStorage)
+#endif
 
 
 
@@ -0,0 +1,277 @@
+// Copyright (C) 2025 Moshe Sulamy
+
+#pragma once
+
+/**
+ * Asynchronous logging:
+ *   BAGEL_LOG_INFO("Ball hit brick {}, {} hits left", id, hits);
+ *   BAGEL_LOG_FLUSH();                 // writes everything logged so far
+ * A call copies the format pointer and its arguments, unformatted, into a ring owned by
+ * the calling thread: no lock, no allocation, no I/O. A background thread formats the
+ * records ({} is replaced by the next argument) and writes them to stdout. A thread's ring
+ * is freed once the thread has exited and its records are written.
+ * Levels below BAGEL_LOG_LEVEL (0 debug, 1 info, 2 warn, 3 error, 4 none) compile to nothing.
+ */
+#include "bagel.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifndef BAGEL_LOG_LEVEL
+#define BAGEL_LOG_LEVEL 0
+#endif
+
+namespace bagel
+{
+	enum class LogLevel : std::uint8_t { Debug, Info, Warn, Error };
+
+	class Logger final : NoInstance
+	{
+	public:
+		static constexpr size_type MaxArgs = 6;
+		static constexpr size_type Capacity = 1 << 12;	// records per thread, power of two
+		static constexpr size_type TextBytes = 32;		// string arguments per record, NULs included
+
+		// Arguments are arithmetic, enums or strings. Strings are copied into the record (up to
+		// TextBytes in all, longer ones are cut), so they need not outlive the call.
+		template <size_type N, class... Args>
+		static void log(LogLevel level, const char (&fmt)[N], const Args&... args) {
+			static_assert(sizeof...(Args) <= MaxArgs, "too many log arguments");
+			Ring& r = ring();
+			const std::uint64_t head = r.head.load(std::memory_order_relaxed);
+			if (head - r.cachedTail >= Capacity) {
+				r.cachedTail = r.tail.load(std::memory_order_acquire);
+				if (head - r.cachedTail >= Capacity) {
+					// Never block the caller: the record is lost and counted
+					r.dropped.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+			}
+			Record& rec = r.records[head & (Capacity-1)];
+			rec.fmt = fmt;
+			rec.time = now();
+			rec.level = level;
+			rec.argc = static_cast<std::uint8_t>(sizeof...(Args));
+			rec.textUsed = 0;
+			[[maybe_unused]] size_type i = 0;
+			(encode(rec, i++, args), ...);
+			r.head.store(head+1, std::memory_order_release);
+		}
+
+		// Writes every record logged so far (by any thread) before returning.
+		static void flush() {
+			drain();
+		}
+
+		// Where records are written (stdout by default); set before the first record.
+		static void setOutput(FILE* out) { _out = out; }
+	private:
+		union Value {
+			std::int64_t	i;
+			std::uint64_t	u;
+			double			d;
+		};
+		struct Record {
+			const char*		fmt;
+			std::int64_t	time;	// ns since the first record
+			Value			args[MaxArgs];
+			char			types[MaxArgs];
+			std::uint8_t	argc;
+			LogLevel		level;
+			std::uint8_t	textUsed;
+			char			text[TextBytes];	// string arguments (args[i].u: offset)
+		};
+		// Single producer (the owning thread), single consumer (whoever drains).
+		struct Ring {
+			alignas(64) std::atomic<std::uint64_t>	head{0};
+			std::uint64_t							cachedTail = 0;	// producer's copy of tail
+			std::atomic<std::uint64_t>				dropped{0};
+			std::atomic<bool>						retired{false};	// the owning thread exited
+			alignas(64) std::atomic<std::uint64_t>	tail{0};
+			Record									records[Capacity];
+		};
+		// Retires the thread's ring when the thread exits.
+		struct RingOwner {
+			Ring* ring;
+			~RingOwner() { ring->retired.store(true, std::memory_order_release); }
+		};
+		struct Writer {
+			std::thread				thread;
+			std::atomic<bool>		stop{false};
+			~Writer() {
+				if (thread.joinable()) {
+					stop.store(true, std::memory_order_release);
+					thread.join();
+				}
+				drain();
+			}
+		};
+
+		static std::int64_t now() {
+			using namespace std::chrono;
+			static const steady_clock::time_point origin = steady_clock::now();
+			return duration_cast<nanoseconds>(steady_clock::now() - origin).count();
+		}
+
+		template <class T>
+		static void encode(Record& rec, size_type i, const T& v) {
+			if constexpr (std::is_same_v<T, bool>) {
+				rec.types[i] = 'b';
+				rec.args[i].u = v;
+			} else if constexpr (std::is_enum_v<T>) {
+				encode(rec, i, static_cast<std::underlying_type_t<T>>(v));
+			} else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+				rec.types[i] = 'i';
+				rec.args[i].i = v;
+			} else if constexpr (std::is_integral_v<T>) {
+				rec.types[i] = 'u';
+				rec.args[i].u = v;
+			} else if constexpr (std::is_floating_point_v<T>) {
+				rec.types[i] = 'd';
+				rec.args[i].d = v;
+			} else if constexpr (std::is_convertible_v<const T&, const char*>) {
+				const char* s = v;
+				copyText(rec, i, s != nullptr ? std::string_view(s) : std::string_view("(null)"));
+			} else {
+				static_assert(std::is_convertible_v<const T&, std::string_view>, "unsupported log argument");
+				copyText(rec, i, std::string_view(v));
+			}
+		}
+		static void copyText(Record& rec, size_type i, std::string_view s) {
+			rec.types[i] = 's';
+			if (rec.textUsed == TextBytes) {
+				rec.args[i].u = TextBytes-1;	// the previous string's NUL: empty
+				return;
+			}
+			const size_t n = std::min(s.size(), static_cast<size_t>(TextBytes - rec.textUsed - 1));
+			memcpy(rec.text + rec.textUsed, s.data(), n);
+			rec.text[rec.textUsed + n] = '\0';
+			rec.args[i].u = rec.textUsed;
+			rec.textUsed = static_cast<std::uint8_t>(rec.textUsed + n + 1);
+		}
+
+		// Constructed after the members below, so destroyed (joined and drained) before them.
+		static Writer& writer() {
+			static Writer w;
+			return w;
+		}
+
+		static Ring& ring() {
+			thread_local RingOwner owner{addRing()};
+			return *owner.ring;
+		}
+		// Once per thread. A ring outlives its thread until drain() has written its records.
+		static Ring* addRing() {
+			std::lock_guard<std::mutex> lock(_ringsMutex);
+			_rings.push_back(std::make_unique<Ring>());
+			Writer& w = writer();
+			if (!w.thread.joinable())
+				w.thread = std::thread(&Logger::writeLoop);
+			return _rings.back().get();
+		}
+
+		static void writeLoop() {
+			while (!writer().stop.load(std::memory_order_acquire)) {
+				if (drain() == 0)
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+
+		// Writes the records of all rings in time order; returns how many.
+		static size_type drain() {
+			std::lock_guard<std::mutex> drainLock(_drainMutex);
+			std::uint64_t dropped = 0;
+			_pending.clear();
+			{
+				std::lock_guard<std::mutex> lock(_ringsMutex);
+				for (size_t k = 0; k < _rings.size();) {
+					Ring& r = *_rings[k];
+					// Read before head: once retired, everything the thread logged is below head
+					const bool retired = r.retired.load(std::memory_order_acquire);
+					const std::uint64_t tail = r.tail.load(std::memory_order_relaxed);
+					const std::uint64_t head = r.head.load(std::memory_order_acquire);
+					for (std::uint64_t t = tail; t != head; ++t)
+						_pending.push_back(r.records[t & (Capacity-1)]);
+					r.tail.store(head, std::memory_order_release);
+					dropped += r.dropped.exchange(0, std::memory_order_relaxed);
+					if (retired) {
+						_rings[k] = std::move(_rings.back());
+						_rings.pop_back();
+					} else {
+						++k;
+					}
+				}
+			}
+			std::stable_sort(_pending.begin(), _pending.end(),
+				[](const Record& a, const Record& b) { return a.time < b.time; });
+
+			FILE* out = _out != nullptr ? _out : stdout;
+			for (const Record& rec : _pending)
+				write(out, rec);
+			if (dropped > 0)
+				fprintf(out, "[log] %llu records dropped\n", static_cast<unsigned long long>(dropped));
+			if (!_pending.empty() || dropped > 0)
+				fflush(out);
+			return static_cast<size_type>(_pending.size());
+		}
+
+		static void write(FILE* out, const Record& rec) {
+			fprintf(out, "[%10.3f %c] ", rec.time / 1e6, "DIWE"[static_cast<int>(rec.level)]);
+			size_type arg = 0;
+			for (const char* p = rec.fmt; *p != '\0'; ++p) {
+				if (p[0] == '{' && p[1] == '}' && arg < rec.argc) {
+					const Value& v = rec.args[arg];
+					switch (rec.types[arg++]) {
+					case 'b': fputs(v.u ? "true" : "false", out); break;
+					case 'i': fprintf(out, "%lld", static_cast<long long>(v.i)); break;
+					case 'u': fprintf(out, "%llu", static_cast<unsigned long long>(v.u)); break;
+					case 'd': fprintf(out, "%g", v.d); break;
+					case 's': fputs(rec.text + v.u, out); break;
+					}
+					++p;
+				} else {
+					fputc(*p, out);
+				}
+			}
+			fputc('\n', out);
+		}
+
+		static inline FILE*								_out = nullptr;
+		static inline std::mutex						_ringsMutex;
+		static inline std::vector<std::unique_ptr<Ring>> _rings;
+		static inline std::mutex						_drainMutex;
+		static inline std::vector<Record>				_pending;
+	};
+}
+
+#define BAGEL_LOG_FLUSH() ::bagel::Logger::flush()
+
+#if BAGEL_LOG_LEVEL <= 0
+#define BAGEL_LOG_DEBUG(...) ::bagel::Logger::log(::bagel::LogLevel::Debug, __VA_ARGS__)
+#else
+#define BAGEL_LOG_DEBUG(...) ((void)0)
+#endif
+#if BAGEL_LOG_LEVEL <= 1
+#define BAGEL_LOG_INFO(...) ::bagel::Logger::log(::bagel::LogLevel::Info, __VA_ARGS__)
+#else
+#define BAGEL_LOG_INFO(...) ((void)0)
+#endif
+#if BAGEL_LOG_LEVEL <= 2
+#define BAGEL_LOG_WARN(...) ::bagel::Logger::log(::bagel::LogLevel::Warn, __VA_ARGS__)
+#else
+#define BAGEL_LOG_WARN(...) ((void)0)
+#endif
+#if BAGEL_LOG_LEVEL <= 3
+#define BAGEL_LOG_ERROR(...) ::bagel::Logger::log(::bagel::LogLevel::Error, __VA_ARGS__)
+#else
+#define BAGEL_LOG_ERROR(...) ((void)0)
+#endif
@@ -0,0 +1,138 @@
+// Copyright (C) 2025 Moshe Sulamy
+
+#pragma once
+
+/**
+ * Scoped timing zones, compiled in only when BAGEL_PROFILE is defined:
+ *   BAGEL_ZONE("Movement");            // times the enclosing scope
+ *   BAGEL_PROFILE_DUMP("trace.json");  // Chrome trace_event JSON (chrome://tracing, Perfetto)
+ *   BAGEL_PROFILE_REPORT(std::cout);   // p50/p95/p99 per zone name
+ * Without BAGEL_PROFILE the macros expand to nothing and this header pulls in nothing.
+ */
+#ifdef BAGEL_PROFILE
+
+#include "bagel.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+namespace bagel
+{
+	/**
+	 * Fixed ring of finished zones. Writers claim a slot with one fetch_add and never
+	 * block; once the ring is full the oldest zones are overwritten. dump() and report()
+	 * read the ring as is, so call them when no zone is running (e.g. at shutdown).
+	 */
+	class Profiler final : NoInstance
+	{
+	public:
+		static constexpr size_type Capacity = 1 << 16;	// power of two
+
+		struct Zone {
+			const char*		name;	// string literal
+			std::int64_t	start;	// ns since the first zone
+			std::int64_t	end;
+			index_type		thread;
+		};
+
+		static std::int64_t now() {
+			using namespace std::chrono;
+			static const steady_clock::time_point origin = steady_clock::now();
+			return duration_cast<nanoseconds>(steady_clock::now() - origin).count();
+		}
+
+		static void record(const char* name, std::int64_t start, std::int64_t end) {
+			std::uint64_t slot = _next.fetch_add(1, std::memory_order_relaxed);
+			_ring[slot & (Capacity-1)] = {name, start, end, threadIndex()};
+		}
+
+		// Number of zones still in the ring.
+		static size_type size() {
+			return static_cast<size_type>(std::min<std::uint64_t>(_next.load(), Capacity));
+		}
+
+		static bool dump(const char* path) {
+			FILE* f = fopen(path, "w");
+			if (f == nullptr)
+				return false;
+			fprintf(f, "{\"traceEvents\":[\n");
+			const size_type n = size();
+			const std::uint64_t first = _next.load() - n;
+			for (size_type i = 0; i < n; ++i) {
+				const Zone& z = _ring[(first + i) & (Capacity-1)];
+				fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}\n",
+					i == 0 ? "" : ",", z.name, z.thread, z.start / 1000.0, (z.end - z.start) / 1000.0);
+			}
+			fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+			fclose(f);
+			return true;
+		}
+
+		// Duration percentiles per zone name, over the zones still in the ring.
+		static void report(std::ostream& out) {
+			const size_type n = size();
+			const std::uint64_t first = _next.load() - n;
+			std::vector<const Zone*> zones;
+			zones.reserve(n);
+			for (size_type i = 0; i < n; ++i)
+				zones.push_back(&_ring[(first + i) & (Capacity-1)]);
+			std::sort(zones.begin(), zones.end(), [](const Zone* a, const Zone* b) {
+				const int c = strcmp(a->name, b->name);
+				return c != 0 ? c < 0 : dur(*a) < dur(*b);
+			});
+
+			out << "zone                      count     p50 ms     p95 ms     p99 ms\n";
+			for (size_type b = 0, e; b < n; b = e) {
+				for (e = b; e < n && strcmp(zones[e]->name, zones[b]->name) == 0; ++e);
+				const size_type count = e - b;
+				char line[128];
+				snprintf(line, sizeof(line), "%-24s %6d %10.3f %10.3f %10.3f\n", zones[b]->name, count,
+					pct(&zones[b], count, 50), pct(&zones[b], count, 95), pct(&zones[b], count, 99));
+				out << line;
+			}
+		}
+	private:
+		static std::int64_t dur(const Zone& z) { return z.end - z.start; }
+		static double pct(const Zone* const* sorted, size_type count, int p) {
+			size_type i = std::min(count-1, (count * p + 99) / 100 - 1);
+			return dur(*sorted[std::max(0, i)]) / 1e6;
+		}
+		static index_type threadIndex() {
+			static std::atomic<index_type> threads{0};
+			thread_local index_type idx = threads.fetch_add(1, std::memory_order_relaxed);
+			return idx;
+		}
+
+		static inline Zone							_ring[Capacity] = {};
+		static inline std::atomic<std::uint64_t>	_next{0};
+	};
+
+	class ProfileZone : NoCopy
+	{
+	public:
+		explicit ProfileZone(const char* name) : _name(name), _start(Profiler::now()) {}
+		~ProfileZone() { Profiler::record(_name, _start, Profiler::now()); }
+	private:
+		const char*		_name;
+		std::int64_t	_start;
+	};
+}
+
+#define BAGEL_ZONE_CAT2(a,b) a##b
+#define BAGEL_ZONE_CAT(a,b) BAGEL_ZONE_CAT2(a,b)
+#define BAGEL_ZONE(name) ::bagel::ProfileZone BAGEL_ZONE_CAT(bagelZone, __LINE__){name}
+#define BAGEL_PROFILE_DUMP(path) ::bagel::Profiler::dump(path)
+#define BAGEL_PROFILE_REPORT(out) ::bagel::Profiler::report(out)
+
+#else
+
+#define BAGEL_ZONE(name) ((void)0)
+#define BAGEL_PROFILE_DUMP(path) ((void)0)
+#define BAGEL_PROFILE_REPORT(out) ((void)0)
+
+#endif
@@ -0,0 +1,250 @@
+// Copyright (C) 2025 Moshe Sulamy
+
+#pragma once
+#include "bagel.h"
+#include <cstdint>
+#include <mutex>
+
+namespace bagel
+{
+	/**
+	 * Ring buffer of per-tick World deltas, to step back and forth between ticks (replays,
+	 * rewind debugging). Every element the World and its storages report to Journal is
+	 * recorded by page: the page's bytes before its first change in the tick, and its bytes
+	 * once the tick is committed, plus the extent (size) of each changed array. Undoing or
+	 * redoing a tick copies only its pages back, so the cost follows what changed, not the
+	 * size of the World. The oldest ticks are dropped to keep the recorded bytes within the
+	 * budget (the newest tick is always kept).
+	 *
+	 * Requires Params.TrackWrites (otherwise nothing is recorded). Only the World's own
+	 * state is covered: not ArchetypeStorage rows, nor anything the application keeps
+	 * outside the World. One Rewind records a World at a time; call commit(), rollback() and
+	 * forward() between ticks. State kept outside the World (e.g. a physics engine, timers)
+	 * is not rolled back with it: unless the application restores it too, a rolled back
+	 * World can be inspected or replayed forward, but the simulation must not resume from it.
+	 */
+	class Rewind : NoCopy
+	{
+	public:
+		static constexpr size_type PageBytes = 256;
+		static constexpr bool Enabled = Params.TrackWrites;
+
+		// Records the changes of a World, by default the one of the calling thread.
+		explicit Rewind(size_t budget = size_t{64} << 20, size_type maxTicks = 1024,
+				World& world = World::current())
+			: _journal(world.journal()), _budget(budget), _capacity(maxTicks + 1), _frames(new Frame[maxTicks + 1]),
+			  _arrays(static_cast<ArrayState*>(calloc(Journal::Capacity, sizeof(ArrayState)))) {
+			_journal.attach(written, this);
+		}
+		~Rewind() {
+			_journal.attach(nullptr, nullptr);
+			for (index_type i = 0; i < Journal::Capacity; ++i)
+				free(_arrays[i].stamps);
+			free(_arrays);
+			delete[] _frames;
+		}
+
+		// Closes the current tick (changes since the last commit). Discards the ticks
+		// undone by rollback() and not redone.
+		void commit() {
+			std::lock_guard<std::mutex> lock(_mutex);
+			commitLocked();
+		}
+
+		// Undoes up to k committed ticks, newest first (uncommitted changes are committed
+		// first). Returns the number of ticks undone.
+		size_type rollback(size_type k) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (_count == _cursor && open().arrays.size() > 0)
+				commitLocked();
+			size_type n = 0;
+			for (; n < k && _cursor > 0; ++n)
+				apply(frame(--_cursor), false);
+			return n;
+		}
+		// Redoes up to k ticks undone by rollback(). Returns the number of ticks redone.
+		size_type forward(size_type k) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			size_type n = 0;
+			for (; n < k && _cursor < _count; ++n)
+				apply(frame(_cursor++), true);
+			return n;
+		}
+
+		// Committed ticks that can be undone, and undone ticks that can be redone.
+		size_type past() const { return _cursor; }
+		size_type future() const { return _count - _cursor; }
+		// Bytes held by the committed ticks.
+		size_t bytes() const { return _bytes; }
+
+		// Forgets every tick, e.g. after World::load replaced the World.
+		void clear() {
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (index_type i = 0; i < _count; ++i)
+				frame(i).clear();
+			open().clear();
+			_first = _count = _cursor = 0;
+			_bytes = 0;
+			++_serial;
+		}
+	private:
+		struct ArrayChange {
+			index_type	array;
+			size_type	from;	// extent at the start of the tick
+			size_type	peak;	// largest extent seen during the tick
+			size_type	to;		// extent at commit
+		};
+		struct PageChange {
+			index_type	array;
+			index_type	page;
+			size_t		before;	// offsets in Frame::bytes
+			size_t		after;
+			size_type	beforeBytes;
+			size_type	afterBytes;
+		};
+		struct Frame {
+			DynamicBag<ArrayChange,16>		arrays;
+			DynamicBag<PageChange,64>		pages;
+			DynamicBag<unsigned char,4096>	bytes;
+
+			size_t size() const {
+				return arrays.size()*sizeof(ArrayChange) + pages.size()*sizeof(PageChange) + bytes.size();
+			}
+			void clear() {
+				arrays.clear();
+				pages.clear();
+				bytes.clear();
+			}
+		};
+		// Per tracked array: the tick (serial) its pages and extent were last recorded in.
+		struct ArrayState {
+			std::uint32_t*	stamps;
+			size_type		pages;
+			std::uint32_t	serial;
+			index_type		change;	// in the open frame's arrays
+		};
+
+		static size_type perPage(const Journal::Array& a) { return std::max(1, PageBytes / a.elemSize); }
+
+		Frame& frame(index_type i) { return _frames[(_first + i) % _capacity]; }
+		Frame& open() { return frame(_count); }
+
+		static void written(void* ctx, index_type array, index_type first, size_type n) {
+			Rewind& r = *static_cast<Rewind*>(ctx);
+			std::lock_guard<std::mutex> lock(r._mutex);
+			r.record(array, first, n);
+		}
+
+		// Saves the pages of [first, first+n) not yet saved this tick, before they change.
+		void record(index_type array, index_type first, size_type n) {
+			if (_count > _cursor)
+				discardFuture();
+			Frame& f = open();
+			const Journal::Array& a = _journal.array(array);
+			ArrayState& s = _arrays[array];
+			const size_type extent = a.extent(a.target);
+			if (s.serial != _serial) {
+				s.serial = _serial;
+				s.change = f.arrays.size();
+				f.arrays.push({array, extent, extent, extent});
+			}
+			ArrayChange& c = f.arrays[s.change];
+			c.peak = std::max(c.peak, extent);
+
+			const size_type per = perPage(a);
+			const index_type last = (first + n - 1) / per;
+			if (last >= s.pages) {
+				const size_type pages = std::max(last + 1, s.pages*2);
+				s.stamps = static_cast<std::uint32_t*>(realloc(s.stamps, sizeof(std::uint32_t)*pages));
+				memset(s.stamps + s.pages, 0, sizeof(std::uint32_t)*(pages - s.pages));
+				s.pages = pages;
+			}
+			for (index_type p = first / per; p <= last; ++p) {
+				if (s.stamps[p] == _serial)
+					continue;
+				s.stamps[p] = _serial;
+				const size_type bytes = pageBytes(a, p, extent);
+				f.pages.push({array, p, append(f, a, p, bytes), 0, bytes, 0});
+			}
+		}
+
+		void commitLocked() {
+			if (_count > _cursor)
+				discardFuture();
+			Frame& f = open();
+			for (index_type i = 0; i < f.arrays.size(); ++i) {
+				const Journal::Array& a = _journal.array(f.arrays[i].array);
+				f.arrays[i].to = a.extent(a.target);
+				f.arrays[i].peak = std::max(f.arrays[i].peak, f.arrays[i].to);
+			}
+			for (index_type i = 0; i < f.pages.size(); ++i) {
+				PageChange& pc = f.pages[i];
+				const Journal::Array& a = _journal.array(pc.array);
+				pc.afterBytes = pageBytes(a, pc.page, a.extent(a.target));
+				pc.after = append(f, a, pc.page, pc.afterBytes);
+			}
+			_bytes += f.size();
+			++_count;
+			++_cursor;
+			++_serial;
+
+			while (_count > 1 && (_count >= _capacity || _bytes > _budget)) {
+				_bytes -= frame(0).size();
+				frame(0).clear();
+				_first = (_first + 1) % _capacity;
+				--_count;
+				--_cursor;
+			}
+		}
+
+		void discardFuture() {
+			for (index_type i = _cursor; i < _count; ++i) {
+				_bytes -= frame(i).size();
+				frame(i).clear();
+			}
+			_count = _cursor;
+		}
+
+		static size_type pageBytes(const Journal::Array& a, index_type page, size_type extent) {
+			const size_type per = perPage(a);
+			return std::max(0, std::min(per, extent - page*per)) * a.elemSize;
+		}
+		static size_t append(Frame& f, const Journal::Array& a, index_type page, size_type bytes) {
+			const size_t at = f.bytes.size();
+			f.bytes.resize(f.bytes.size() + bytes);
+			memcpy(f.bytes.data() + at, a.data(a.target) + static_cast<size_t>(page)*perPage(a)*a.elemSize, bytes);
+			return at;
+		}
+
+		// Restores the arrays of a tick as they were before it (redo: after it).
+		void apply(Frame& f, bool redo) {
+			for (index_type i = 0; i < f.arrays.size(); ++i) {
+				const Journal::Array& a = _journal.array(f.arrays[i].array);
+				a.restore(a.target, f.arrays[i].peak);
+			}
+			for (index_type i = 0; i < f.pages.size(); ++i) {
+				const PageChange& pc = f.pages[i];
+				const Journal::Array& a = _journal.array(pc.array);
+				memcpy(a.data(a.target) + static_cast<size_t>(pc.page)*perPage(a)*a.elemSize,
+					f.bytes.data() + (redo ? pc.after : pc.before), redo ? pc.afterBytes : pc.beforeBytes);
+			}
+			for (index_type i = 0; i < f.arrays.size(); ++i) {
+				const Journal::Array& a = _journal.array(f.arrays[i].array);
+				a.restore(a.target, redo ? f.arrays[i].to : f.arrays[i].from);
+			}
+			++_serial;
+		}
+
+		Journal&		_journal;
+		size_t			_budget;
+		size_type		_capacity;
+		Frame*			_frames;
+		ArrayState*		_arrays;
+		index_type		_first = 0;		// oldest committed tick in _frames
+		size_type		_count = 0;		// committed ticks, undone ones included
+		size_type		_cursor = 0;	// committed ticks currently applied
+		size_t			_bytes = 0;
+		std::uint32_t	_serial = 1;
+		std::mutex		_mutex;
+	};
+}
@@ -0,0 +1,293 @@
+// Copyright (C) 2025 Moshe Sulamy
+
+#pragma once
+#include "bagel.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace bagel
+{
+	/**
+	 * Work-stealing thread pool. Every thread has its own job deque: it pops its own
+	 * jobs from the back and steals from the front of the others when it runs dry.
+	 * The thread that constructs the JobSystem is worker 0 and takes part through
+	 * tryRun() / wait(); jobs submitted from outside the pool land in its deque.
+	 */
+	class JobSystem : NoCopy
+	{
+	public:
+		using Fn = void (*)(void* ctx, index_type begin, index_type end, index_type worker);
+		using Counter = std::atomic<size_type>;
+
+		explicit JobSystem(size_type threads = defaultThreads())
+			: _count(threads + 1), _queues(new Queue[threads + 1]) {
+			_self = 0;
+			_owner = this;
+			for (index_type i = 1; i < _count; ++i)
+				_threads.emplace_back(&JobSystem::work, this, i);
+		}
+		~JobSystem() {
+			{
+				std::lock_guard<std::mutex> lock(_sleepMutex);
+				_stop = true;
+			}
+			_wake.notify_all();
+			for (std::thread& t : _threads)
+				t.join();
+		}
+
+		// Threads that may run jobs concurrently, the owner included.
+		size_type workerCount() const { return _count; }
+		// Index of the calling thread in this pool (0 outside of it).
+		index_type workerIndex() const { return _owner == this ? _self : 0; }
+
+		// Queues fn(ctx, begin, end, worker). The counter, if any, is incremented now
+		// and decremented once the job has run.
+		void submit(Fn fn, void* ctx, index_type begin, index_type end, Counter* done = nullptr) {
+			if (done)
+				done->fetch_add(1, std::memory_order_relaxed);
+			Queue& q = _queues[workerIndex()];
+			{
+				std::lock_guard<std::mutex> lock(q.mutex);
+				q.jobs.push_back({fn, ctx, begin, end, done});
+			}
+			_queued.fetch_add(1, std::memory_order_release);
+			{
+				std::lock_guard<std::mutex> lock(_sleepMutex);
+			}
+			_wake.notify_one();
+		}
+
+		// Runs one queued job on the calling thread; false if there was none.
+		bool tryRun() {
+			Job job;
+			if (!pop(workerIndex(), job))
+				return false;
+			run(job);
+			return true;
+		}
+		// Helps running jobs until the counter drops to zero.
+		void wait(const Counter& done) {
+			while (done.load(std::memory_order_acquire) > 0)
+				if (!tryRun())
+					std::this_thread::yield();
+		}
+
+		static size_type defaultThreads() {
+			size_type n = static_cast<size_type>(std::thread::hardware_concurrency());
+			return n > 1 ? n-1 : 0;
+		}
+	private:
+		struct Job {
+			Fn			fn;
+			void*		ctx;
+			index_type	begin;
+			index_type	end;
+			Counter*	done;
+		};
+		struct Queue {
+			std::mutex			mutex;
+			std::deque<Job>		jobs;
+		};
+
+		void work(index_type self) {
+			_self = self;
+			_owner = this;
+			for (;;) {
+				Job job;
+				if (pop(self, job)) {
+					run(job);
+					continue;
+				}
+				std::unique_lock<std::mutex> lock(_sleepMutex);
+				_wake.wait(lock, [this] {
+					return _stop || _queued.load(std::memory_order_acquire) > 0;
+				});
+				if (_stop)
+					return;
+			}
+		}
+
+		bool pop(index_type self, Job& job) {
+			if (_queued.load(std::memory_order_acquire) == 0)
+				return false;
+			for (index_type k = 0; k < _count; ++k) {
+				Queue& q = _queues[(self + k) % _count];
+				std::lock_guard<std::mutex> lock(q.mutex);
+				if (q.jobs.empty())
+					continue;
+				if (k == 0) {
+					job = q.jobs.back();
+					q.jobs.pop_back();
+				} else {
+					job = q.jobs.front();
+					q.jobs.pop_front();
+				}
+				_queued.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+			return false;
+		}
+
+		void run(const Job& job) {
+			job.fn(job.ctx, job.begin, job.end, workerIndex());
+			if (job.done)
+				job.done->fetch_sub(1, std::memory_order_release);
+		}
+
+		size_type						_count;
+		std::unique_ptr<Queue[]>		_queues;
+		std::vector<std::thread>		_threads;
+		std::atomic<size_type>			_queued{0};
+		std::mutex						_sleepMutex;
+		std::condition_variable			_wake;
+		bool							_stop = false;
+
+		static inline thread_local index_type			_self = 0;
+		static inline thread_local const JobSystem*		_owner = nullptr;
+	};
+
+	/**
+	 * Access declaration of a system: System<Reads<A,B>, Writes<C>>.
+	 * Any type can be listed, not only components: a tag type standing for a shared
+	 * resource (a physics world, a renderer) orders the systems that use it.
+	 */
+	template <class...> struct Reads {};
+	template <class...> struct Writes {};
+	template <class T> struct AccessKey final : NoInstance { static inline const char key = 0; };
+
+	template <class = Reads<>, class = Writes<>> struct System;
+	template <class ...Rs, class ...Ws>
+	struct System<Reads<Rs...>, Writes<Ws...>> final
+	{
+		static std::vector<const void*> reads() { return {&AccessKey<Rs>::key...}; }
+		static std::vector<const void*> writes() { return {&AccessKey<Ws>::key...}; }
+	};
+
+	/**
+	 * Runs a set of systems once per call of run(). Two systems conflict when one
+	 * writes something the other reads or writes; conflicting systems run in the
+	 * order they were added, the others run concurrently on the JobSystem.
+	 * Each system records into its own CommandBuffer (bound to local() while it
+	 * runs), so World::step() replays the changes in the order the systems were added.
+	 */
+	class Scheduler : NoCopy
+	{
+	public:
+		// Systems run on the given World, by default the one of the calling thread.
+		explicit Scheduler(JobSystem& jobs, World& world = World::current()) : _jobs(jobs), _world(world) {}
+
+		template <class S, class F>
+		void add(S, F&& f) { push<S>(std::forward<F>(f), false); }
+		// For systems bound to the thread calling run() (input, rendering).
+		template <class S, class F>
+		void addMain(S, F&& f) { push<S>(std::forward<F>(f), true); }
+
+		size_type size() const { return static_cast<size_type>(_nodes.size()); }
+
+		void run() {
+			const size_type n = size();
+			_finished.store(0, std::memory_order_relaxed);
+			for (index_type i = 0; i < n; ++i)
+				_nodes[i]->remaining.store(_nodes[i]->deps, std::memory_order_relaxed);
+			for (index_type i = 0; i < n; ++i)
+				if (_nodes[i]->deps == 0)
+					dispatch(i);
+
+			while (_finished.load(std::memory_order_acquire) < n) {
+				index_type next = popMain();
+				if (next >= 0)
+					execute(next);
+				else if (!_jobs.tryRun())
+					std::this_thread::yield();
+			}
+		}
+	private:
+		struct Node {
+			explicit Node(World& world) : commands(world) {}
+
+			std::function<void()>				fn;
+			std::vector<const void*>			reads;
+			std::vector<const void*>			writes;
+			std::vector<index_type>				next;
+			size_type							deps = 0;
+			std::atomic<size_type>				remaining{0};
+			bool								main = false;
+			CommandBuffer						commands;
+		};
+
+		template <class S, class F>
+		void push(F&& f, bool main) {
+			auto node = std::make_unique<Node>(_world);
+			node->fn = std::forward<F>(f);
+			node->reads = S::reads();
+			node->writes = S::writes();
+			node->main = main;
+
+			const index_type idx = size();
+			for (index_type i = 0; i < idx; ++i) {
+				if (conflict(*_nodes[i], *node)) {
+					_nodes[i]->next.push_back(idx);
+					++node->deps;
+				}
+			}
+			_nodes.push_back(std::move(node));
+		}
+
+		static bool overlap(const std::vector<const void*>& a, const std::vector<const void*>& b) {
+			for (const void* x : a)
+				if (std::find(b.begin(), b.end(), x) != b.end())
+					return true;
+			return false;
+		}
+		static bool conflict(const Node& a, const Node& b) {
+			return overlap(a.writes, b.writes) || overlap(a.writes, b.reads) || overlap(a.reads, b.writes);
+		}
+
+		void dispatch(index_type i) {
+			if (_nodes[i]->main) {
+				std::lock_guard<std::mutex> lock(_mainMutex);
+				_main.push_back(i);
+			}
+			else {
+				_jobs.submit(runJob, this, i, i+1);
+			}
+		}
+		index_type popMain() {
+			std::lock_guard<std::mutex> lock(_mainMutex);
+			if (_main.empty())
+				return -1;
+			index_type i = _main.back();
+			_main.pop_back();
+			return i;
+		}
+
+		static void runJob(void* ctx, index_type begin, index_type, index_type) {
+			static_cast<Scheduler*>(ctx)->execute(begin);
+		}
+		void execute(index_type i) {
+			Node& node = *_nodes[i];
+			{
+				World::Bind world(_world);
+				CommandBuffer::Bind bind(node.commands);
+				node.fn();
+			}
+			for (index_type s : node.next)
+				if (_nodes[s]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					dispatch(s);
+			_finished.fetch_add(1, std::memory_order_release);
+		}
+
+		JobSystem&							_jobs;
+		World&								_world;
+		std::vector<std::unique_ptr<Node>>	_nodes;
+		std::vector<index_type>				_main;
+		std::mutex							_mainMutex;
+		std::atomic<size_type>				_finished{0};
+	};
+}
@@ -0,0 +1,149 @@
+// Copyright (C) 2025 Moshe Sulamy
+
+#pragma once
+#include "bagel.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bagel
+{
+	/**
+	 * Binary World snapshots. A file holds a header, a table of blocks, then every block
+	 * (the arrays of World::save, followed by the application's own blocks) at a BlockAlign
+	 * offset, in native byte order. load() maps the file copy-on-write and the storages
+	 * adopt their arrays where they lie, so loading does no per-entity work; an array is
+	 * copied to the heap only the first time it grows. A file loads only into a build with
+	 * the same storages and component sizes, and only if its block counts agree with each
+	 * other (World::load); both are checked before anything is replaced.
+	 */
+	class Snapshot final : NoInstance
+	{
+	public:
+		static constexpr std::uint32_t Version = 2;	// 2: free ids have odd generations
+		static constexpr size_type BlockAlign = 64;
+
+		// Writes the World and, if given, the application blocks (tags of its own choosing).
+		static bool save(const char* path, const SnapshotBlocks* app = nullptr) {
+			SnapshotBlocks world;
+			if (!World::save(world))
+				return false;
+			const size_type appBlocks = app != nullptr ? app->size() : 0;
+			const size_type total = world.size() + appBlocks;
+
+			Header header{{'B','G','S','N'}, Version, static_cast<std::uint32_t>(sizeof(Mask)),
+				MaxComponents, static_cast<std::uint32_t>(world.size()),
+				static_cast<std::uint32_t>(appBlocks), 0};
+			std::uint64_t offset = align(sizeof(Header) + sizeof(Entry)*total);
+			Entry* entries = static_cast<Entry*>(malloc(sizeof(Entry)*total + 1));
+			for (index_type i = 0; i < total; ++i) {
+				const SnapshotBlocks::Block& b = i < world.size() ? world[i] : (*app)[i - world.size()];
+				entries[i] = {b.tag, b.elemSize, b.count, i >= world.size(), offset};
+				offset = align(offset + static_cast<std::uint64_t>(b.elemSize)*b.count);
+			}
+			header.bytes = offset;
+
+			FILE* f = std::fopen(path, "wb");
+			bool ok = f != nullptr && write(f, &header, sizeof(Header)) && write(f, entries, sizeof(Entry)*total);
+			std::uint64_t at = sizeof(Header) + sizeof(Entry)*total;
+			for (index_type i = 0; ok && i < total; ++i) {
+				const SnapshotBlocks::Block& b = i < world.size() ? world[i] : (*app)[i - world.size()];
+				const std::uint64_t bytes = static_cast<std::uint64_t>(b.elemSize)*b.count;
+				ok = pad(f, entries[i].offset - at) && write(f, b.data, bytes);
+				at = entries[i].offset + bytes;
+			}
+			ok = ok && pad(f, header.bytes - at);
+			free(entries);
+			return f != nullptr && std::fclose(f) == 0 && ok;
+		}
+
+		// Replaces the calling thread's World with the snapshot in a file. app, when given,
+		// is the layout the application blocks must have (as passed to save, contents
+		// ignored). The World holds the mapping until the next load or its destruction.
+		static bool load(const char* path, const SnapshotBlocks* app = nullptr) {
+			int fd = open(path, O_RDONLY);
+			if (fd < 0)
+				return false;
+			struct stat st;
+			const bool sized = fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(Header));
+			void* map = sized ? mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+			close(fd);
+			if (map == MAP_FAILED)
+				return false;
+			const size_t bytes = static_cast<size_t>(st.st_size);
+
+			SnapshotBlocks world, blocks;
+			if (!parse(static_cast<unsigned char*>(map), bytes, world, blocks) ||
+				(app != nullptr && !blocks.sameLayout(*app)) || !World::load(world)) {
+				munmap(map, bytes);
+				return false;
+			}
+
+			_app.clear();
+			for (index_type i = 0; i < blocks.size(); ++i)
+				_app.add(blocks[i]);
+			World::current().setBacking({map, bytes, unmap});
+			return true;
+		}
+
+		// Application blocks of the calling thread's last load(), read back with
+		// begin()/take() in the order they were saved. Valid until that World loads again.
+		static SnapshotBlocks& app() {
+			_app.rewind();
+			return _app;
+		}
+	private:
+		struct Header {
+			char			magic[4];
+			std::uint32_t	version;
+			std::uint32_t	maskBytes;
+			std::int32_t	components;
+			std::uint32_t	worldBlocks;
+			std::uint32_t	appBlocks;
+			std::uint64_t	bytes;
+		};
+		struct Entry {
+			std::int32_t	tag;
+			std::int32_t	elemSize;
+			std::int32_t	count;
+			std::int32_t	app;
+			std::uint64_t	offset;
+		};
+
+		static std::uint64_t align(std::uint64_t n) { return (n + BlockAlign-1) / BlockAlign * BlockAlign; }
+		static bool write(FILE* f, const void* data, std::uint64_t bytes) {
+			return bytes == 0 || std::fwrite(data, 1, bytes, f) == bytes;
+		}
+		static bool pad(FILE* f, std::uint64_t bytes) {
+			static const unsigned char zeros[BlockAlign] = {};
+			return write(f, zeros, bytes);
+		}
+
+		static bool parse(unsigned char* base, size_t bytes, SnapshotBlocks& world, SnapshotBlocks& app) {
+			Header h;
+			memcpy(&h, base, sizeof(Header));
+			const std::uint64_t total = static_cast<std::uint64_t>(h.worldBlocks) + h.appBlocks;
+			if (memcmp(h.magic, "BGSN", 4) != 0 || h.version != Version || h.maskBytes != sizeof(Mask) ||
+				h.components != MaxComponents || h.bytes != bytes || sizeof(Header) + sizeof(Entry)*total > bytes)
+				return false;
+
+			const Entry* entries = reinterpret_cast<const Entry*>(base + sizeof(Header));
+			for (std::uint64_t i = 0; i < total; ++i) {
+				const Entry& e = entries[i];
+				if (e.elemSize <= 0 || e.count < 0 || e.offset % BlockAlign != 0 ||
+					e.offset + static_cast<std::uint64_t>(e.elemSize)*e.count > bytes)
+					return false;
+				(i < h.worldBlocks ? world : app).add({base + e.offset, e.tag, e.elemSize, e.count});
+			}
+			return true;
+		}
+
+		static void unmap(void* map, size_t bytes) { munmap(map, bytes); }
+
+		static inline thread_local SnapshotBlocks	_app;
+	};
+}
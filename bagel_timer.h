@@ -0,0 +1,187 @@
+// Copyright (C) 2025 Moshe Sulamy
+
+#pragma once
+#include "bagel.h"
+#include <cstdint>
+#include <mutex>
+
+namespace bagel
+{
+	/**
+	 * Hierarchical timing wheel: Levels wheels of 64 slots, level L counting in units
+	 * of 64^L ticks. schedule() and cancel() are O(1); advance() touches only the slot of
+	 * the current tick, plus one slot of a coarser level every 64 ticks, whose timers
+	 * move down (cascade). Timers further than 64^Levels ticks away wait in the top
+	 * level and are re-placed until due. Safe to call from several threads.
+	 */
+	class TimerWheel : NoCopy
+	{
+	public:
+		using tick_type = std::uint64_t;
+		// Timer handle: slot index and generation, so a stale id never cancels a reused slot.
+		using timer_id = std::uint64_t;
+
+		static constexpr int Levels = 4;
+		static constexpr int SlotBits = 6;
+		static constexpr int Slots = 1 << SlotBits;
+
+		TimerWheel() { std::fill(_heads, _heads + Levels*Slots, -1); }
+
+		// Fires on the ticks-th call of advance() from now (at least the next one).
+		timer_id schedule(ent_type e, int kind, tick_type ticks) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			index_type n = alloc();
+			_nodes[n].e = e;
+			_nodes[n].kind = kind;
+			_nodes[n].due = _tick + (ticks > 0 ? ticks-1 : 0);
+			place(n);
+			++_size;
+			return static_cast<timer_id>(_nodes[n].gen) << 32 | static_cast<std::uint32_t>(n);
+		}
+		// False if the timer already fired or was cancelled.
+		bool cancel(timer_id id) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			index_type n = static_cast<index_type>(static_cast<std::uint32_t>(id));
+			if (n >= _nodes.size() || _nodes[n].slot < 0 ||
+				_nodes[n].gen != static_cast<std::uint32_t>(id >> 32))
+				return false;
+			unlink(n);
+			release(n);
+			--_size;
+			return true;
+		}
+
+		// Moves time one tick forward and calls fired(entity, kind, id) for every timer due.
+		// The callback runs without the lock held and may schedule new timers.
+		template <class F>
+		void advance(F&& fired) {
+			index_type list;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				const tick_type t = _tick;
+				if ((t & (Slots-1)) == 0) {
+					int top = 1;
+					while (top < Levels-1 && slotOf(t, top) == 0)
+						++top;
+					for (int level = top; level >= 1; --level)
+						cascade(level, slotOf(t, level));
+				}
+				list = _heads[t & (Slots-1)];
+				_heads[t & (Slots-1)] = -1;
+				++_tick;
+
+				// Timers past the top level's range land here early; put them back
+				for (index_type n = list, prev = -1, next; n >= 0; n = next) {
+					next = _nodes[n].next;
+					if (_nodes[n].due == t) {
+						prev = n;
+						continue;
+					}
+					if (prev < 0) list = next;
+					else _nodes[prev].next = next;
+					place(n);
+				}
+				for (index_type n = list; n >= 0; n = _nodes[n].next)
+					_nodes[n].slot = -1;
+			}
+			while (list >= 0) {
+				Node node;
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					node = _nodes[list];
+					release(list);
+					--_size;
+				}
+				fired(node.e, node.kind, static_cast<timer_id>(node.gen) << 32 | static_cast<std::uint32_t>(list));
+				list = node.next;
+			}
+		}
+
+		// Drops every timer; their ids may be handed out again.
+		void clear() {
+			std::lock_guard<std::mutex> lock(_mutex);
+			_nodes.clear();
+			std::fill(_heads, _heads + Levels*Slots, -1);
+			_free = -1;
+			_size = 0;
+		}
+
+		// Ticks advanced so far.
+		tick_type now() const { return _tick; }
+		// Timers scheduled and not yet fired or cancelled.
+		size_type size() const { return _size; }
+	private:
+		struct Node {
+			ent_type		e;
+			int				kind;
+			tick_type		due;
+			index_type		prev;
+			index_type		next;
+			index_type		slot;	// in _heads, -1 when not in the wheel
+			std::uint32_t	gen;
+		};
+
+		static index_type slotOf(tick_type t, int level) {
+			return static_cast<index_type>((t >> (SlotBits*level)) & (Slots-1));
+		}
+
+		index_type alloc() {
+			if (_free >= 0) {
+				index_type n = _free;
+				_free = _nodes[n].next;
+				return n;
+			}
+			_nodes.push(Node{{-1}, 0, 0, -1, -1, -1, 0});
+			return _nodes.size() - 1;
+		}
+		void release(index_type n) {
+			_nodes[n].slot = -1;
+			++_nodes[n].gen;
+			_nodes[n].next = _free;
+			_free = n;
+		}
+
+		// Level from the distance to the due tick, slot from the due tick itself.
+		void place(index_type n) {
+			const tick_type delta = _nodes[n].due >= _tick ? _nodes[n].due - _tick : 0;
+			int level = 0;
+			while (level < Levels-1 && delta >= (tick_type{1} << (SlotBits*(level+1))))
+				++level;
+			tick_type at = _nodes[n].due;
+			if (delta >= (tick_type{1} << (SlotBits*Levels)))
+				at = _tick + (tick_type{1} << (SlotBits*Levels)) - 1;
+			link(n, level*Slots + slotOf(at, level));
+		}
+		void link(index_type n, index_type slot) {
+			_nodes[n].slot = slot;
+			_nodes[n].prev = -1;
+			_nodes[n].next = _heads[slot];
+			if (_heads[slot] >= 0)
+				_nodes[_heads[slot]].prev = n;
+			_heads[slot] = n;
+		}
+		void unlink(index_type n) {
+			Node& node = _nodes[n];
+			if (node.prev >= 0) _nodes[node.prev].next = node.next;
+			else _heads[node.slot] = node.next;
+			if (node.next >= 0) _nodes[node.next].prev = node.prev;
+			node.slot = -1;
+		}
+		void cascade(int level, index_type slot) {
+			index_type n = _heads[level*Slots + slot];
+			_heads[level*Slots + slot] = -1;
+			while (n >= 0) {
+				index_type next = _nodes[n].next;
+				place(n);
+				n = next;
+			}
+		}
+
+		Bag<Node,256>	_nodes;
+		index_type		_heads[Levels*Slots];
+		index_type		_free = -1;
+		tick_type		_tick = 0;
+		size_type		_size = 0;
+		std::mutex		_mutex;
+	};
+}
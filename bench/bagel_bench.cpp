@@ -0,0 +1,475 @@
+/**
+ * @file bagel_bench.cpp
+ * @brief Microbenchmarks of the BAGEL ECS and the breakout systems at 1k to 1M entities.
+ *
+ * `bagel_bench [--out file.json] [--max N] [--filter text] [--workers N] [--label text]
+ *              [--compare baseline.json] [--threshold 0.10]`
+ *
+ * Every scenario runs at 1k, 10k, 100k and 1M entities (up to --max), repeated until it took
+ * at least 0.2 s (3 to 50 runs). Reported per scenario and size:
+ * - ns_per_entity: median time of a run divided by the number of entities (min_ns_per_entity: fastest run).
+ * - bytes_per_entity: growth of the process heap from before the scenario was set up to the end
+ *   of its first run, divided by the number of entities (glibc only, -1 elsewhere). Sizes run in
+ *   increasing order.
+ *
+ * Results are written as JSON. With --compare, every scenario whose ns_per_entity grew by more
+ * than the threshold (relative) over the baseline file is listed and the exit code is 1.
+ */
+
+#include "../breakoutGame/breakout_game.h"
+#include "../breakoutGame/game_world.h"
+#include "../bagel.h"
+#include "../bagel_sched.h"
+#include "../breakoutGame/physics_tasks.h"
+#include "../breakoutGame/sprite_batch.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+/** @brief Bytes of heap in use (small blocks and mmapped ones). */
+static double HeapInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<double>(info.uordblks + info.hblkhd);
+}
+#else
+static double HeapInUse() { return -1.0; }
+#endif
+
+using namespace breakout;
+using bagel::ent_type;
+using bagel::World;
+using Clock = std::chrono::steady_clock;
+
+/** @brief One measured scenario at one size. */
+struct Result {
+    std::string name;
+    int entities = 0;
+    int reps = 0;
+    double nsPerEntity = 0.0;     ///< Median over the runs
+    double minNsPerEntity = 0.0;  ///< Fastest run
+    double bytesPerEntity = -1.0; ///< Process heap after the first run / entities (-1: unknown)
+};
+
+/** @brief Command line options. */
+struct Options {
+    const char* out = "bagel_bench.json";
+    const char* filter = nullptr;
+    const char* label = "";
+    const char* compare = nullptr;
+    double threshold = 0.10;
+    int maxEntities = 1000000;
+    int workers = 0;
+};
+
+static std::vector<Result> results;
+static const Options* options = nullptr;
+
+/** @brief The match the scenarios run in, bound to the main thread for the whole run. */
+static GameWorld* game = nullptr;
+
+/** @brief Heap in use before the current scenario was set up (see MarkHeap). */
+static double heapBase = -1.0;
+
+/** @brief Keeps iteration results alive so the loops are not optimized away. */
+static volatile float sink = 0.0f;
+
+constexpr size_t MIN_REPS = 3;
+constexpr size_t MAX_REPS = 50;
+constexpr std::chrono::milliseconds MIN_TIME{200};
+
+/** @brief Called first by every scenario: the heap it reports is counted from here. */
+static void MarkHeap() { heapBase = HeapInUse(); }
+
+/**
+ * @brief Times `body` (one run over n entities) until MIN_TIME elapsed, calling `reset`
+ * (untimed) after every run, and records the result.
+ */
+template <class Body, class Reset>
+static void Measure(const char* name, int n, Body&& body, Reset&& reset) {
+    if (options->filter != nullptr && std::strstr(name, options->filter) == nullptr) return;
+
+    std::vector<double> samples;
+    double heap = -1.0;
+    const Clock::time_point start = Clock::now();
+    while (samples.size() < MIN_REPS || (samples.size() < MAX_REPS && Clock::now() - start < MIN_TIME)) {
+        const Clock::time_point t0 = Clock::now();
+        body();
+        const Clock::time_point t1 = Clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count() / n);
+        if (samples.size() == 1) heap = HeapInUse();
+        reset();
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result r;
+    r.name = name;
+    r.entities = n;
+    r.reps = static_cast<int>(samples.size());
+    r.nsPerEntity = samples[samples.size() / 2];
+    r.minNsPerEntity = samples.front();
+    r.bytesPerEntity = heap < 0.0 ? -1.0 : (heap - heapBase) / n;
+    results.push_back(r);
+
+    std::printf("%-24s %8d %6d %12.2f %12.2f %12.1f\n", name, n, r.reps, r.nsPerEntity, r.minNsPerEntity,
+                r.bytesPerEntity);
+    std::fflush(stdout);
+}
+
+/** @brief Deterministic pseudo-random float in [lo, hi). */
+static float Random(float lo, float hi) {
+    static std::uint32_t state = 12345u;
+    state = state * 1664525u + 1013904223u;
+    return lo + (hi - lo) * static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+}
+
+static void CreateAll(std::vector<ent_type>& ents, int n) {
+    ents.resize(n);
+    for (int i = 0; i < n; ++i) ents[i] = World::createEntity();
+}
+
+static void DestroyAll(std::vector<ent_type>& ents) {
+    for (ent_type e : ents) World::destroyEntity(e);
+    ents.clear();
+    World::step();
+}
+
+/** @brief Removes game entities the way the game does (bodies, lattice, layer), through DestroySystem. */
+static void DestroyGameEntities(std::vector<ent_type>& ents) {
+    World::step();
+    for (ent_type e : ents) {
+        if (World::isAlive(e)) World::addComponent(e, DestroyedTag{});
+    }
+    DestroySystem(*game);
+    ents.clear();
+    World::step();
+}
+
+//----------------------------------
+/// @section ECS scenarios
+//----------------------------------
+
+static void BenchEntities(int n) {
+    MarkHeap();
+    std::vector<ent_type> ents;
+    ents.reserve(n);
+
+    Measure("create_entity", n, [&] { CreateAll(ents, n); }, [&] { DestroyAll(ents); });
+
+    CreateAll(ents, n);
+    Measure("destroy_entity", n, [&] {
+        for (ent_type e : ents) World::destroyEntity(e);
+    }, [&] { CreateAll(ents, n); });
+    DestroyAll(ents);
+}
+
+/** @brief add/del of component T on n entities that have no other component. */
+template <class T>
+static void BenchStorage(const char* addName, const char* delName, int n, const T& value) {
+    MarkHeap();
+    std::vector<ent_type> ents;
+    CreateAll(ents, n);
+
+    Measure(addName, n, [&] {
+        for (ent_type e : ents) World::addComponent(e, value);
+    }, [&] {
+        for (ent_type e : ents) World::delComponent<T>(e);
+        World::step();
+    });
+
+    for (ent_type e : ents) World::addComponent(e, value);
+    World::step();
+    Measure(delName, n, [&] {
+        for (ent_type e : ents) World::delComponent<T>(e);
+    }, [&] {
+        for (ent_type e : ents) World::addComponent(e, value);
+        World::step();
+    });
+
+    DestroyAll(ents);
+}
+
+/** @brief Every entity has a Position, one in ten a Velocity: visits the entities having both. */
+static void BenchIteration(int n) {
+    MarkHeap();
+    std::vector<ent_type> ents;
+    CreateAll(ents, n);
+    for (int i = 0; i < n; ++i) {
+        World::addComponent(ents[i], Position{static_cast<float>(i), 0.0f});
+        if (i % 10 == 0) World::addComponent(ents[i], Velocity{1.0f, 1.0f});
+    }
+    World::step();
+
+    Measure("mask_scan", n, [] {
+        const bagel::Mask query = bagel::MaskBuilder().set<Position>().set<Velocity>().build();
+        float sum = 0.0f;
+        const bagel::id_type maxId = World::maxId().id;
+        for (bagel::id_type id = 0; id <= maxId; ++id) {
+            ent_type e = World::handle(id);
+            if (World::mask(e).test(query)) sum += World::getComponent<Position>(e).x;
+        }
+        sink = sum;
+    }, [] {});
+
+    Measure("view_iterate", n, [] {
+        float sum = 0.0f;
+        for (ent_type e : bagel::View<bagel::Include<Position, Velocity>>{}) {
+            sum += World::getComponent<Position>(e).x;
+        }
+        sink = sum;
+    }, [] {});
+
+    DestroyAll(ents);
+}
+
+//----------------------------------
+/// @section Breakout system scenarios
+//----------------------------------
+
+static void BenchMovement(int n) {
+    MarkHeap();
+    std::vector<ent_type> ents;
+    CreateAll(ents, n);
+    for (ent_type e : ents) {
+        World::addComponents(e, Position{Random(0.0f, 800.0f), Random(0.0f, 600.0f)},
+                             Velocity{Random(-60.0f, 60.0f), Random(-60.0f, 60.0f)}, Collider{10.0f, 10.0f});
+    }
+    World::step();
+
+    Measure("movement_system", n, [] { MovementSystem(*game, 1.0f / 60.0f); }, [] { World::step(); });
+
+    DestroyAll(ents);
+}
+
+/** @brief Job moving the match worlds[begin] (ctx: the worlds of BenchMovementWorlds). */
+static void MoveWorld(void* ctx, bagel::index_type begin, bagel::index_type, bagel::index_type) {
+    auto& worlds = *static_cast<std::vector<std::unique_ptr<GameWorld>>*>(ctx);
+    MovementSystem(*worlds[begin], 1.0f / 60.0f);
+}
+
+/**
+ * @brief The movement scenario split over independent matches, one GameWorld per thread
+ * (--workers threads, one per hardware thread by default): n / threads entities each.
+ * The threads are a JobSystem kept alive across runs, so a run only pays for waking them.
+ */
+static void BenchMovementWorlds(int n) {
+    MarkHeap();
+    const int threads = options->workers > 0 ? options->workers : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<std::unique_ptr<GameWorld>> worlds;
+    for (int t = 0; t < threads; ++t) {
+        worlds.push_back(std::make_unique<GameWorld>());
+        World::Bind bind(worlds.back()->ecs);
+        for (int i = t; i < n; i += threads) {
+            World::addComponents(World::createEntity(), Position{Random(0.0f, 800.0f), Random(0.0f, 600.0f)},
+                                 Velocity{Random(-60.0f, 60.0f), Random(-60.0f, 60.0f)}, Collider{10.0f, 10.0f});
+        }
+        World::step();
+    }
+
+    // One job per match; one run is over when the slowest is done
+    bagel::JobSystem pool(threads - 1);
+    Measure("movement_worlds", n, [&worlds, &pool, threads] {
+        bagel::JobSystem::Counter done{0};
+        for (int t = 0; t < threads; ++t) pool.submit(MoveWorld, &worlds, t, t + 1, &done);
+        pool.wait(done);
+    }, [&worlds] {
+        for (std::unique_ptr<GameWorld>& world : worlds) {
+            World::Bind bind(world->ecs);
+            World::step();
+        }
+    });
+}
+
+/** @brief n resting lasers over the brick grid: one lattice query and AABB tests per laser. */
+static void BenchCollision(int n, PhysicsTasks& tasks) {
+    MarkHeap();
+    PrepareBoxWorld(*game, tasks);
+    CreateBrickGrid(*game, 4, 6, 1);
+
+    std::vector<ent_type> ents;
+    for (ent_type e : bagel::View<bagel::Include<LatticeTag>>{}) ents.push_back(e);
+    for (int i = 0; i < n; ++i) {
+        ent_type e = World::handle(CreateLaser(*game, Random(20.0f, 780.0f), Random(60.0f, 270.0f)));
+        World::getComponent<Velocity>(e) = {};
+        ents.push_back(e);
+    }
+    World::step();
+
+    Measure("collision_system", n, [] { CollisionSystem(*game); }, [] { World::step(); });
+
+    DestroyGameEntities(ents);
+}
+
+/** @brief n balls moving in parallel on a grid (never touching): n bodies to solve and sync. */
+static void BenchPhysics(int n, PhysicsTasks& tasks) {
+    MarkHeap();
+    PrepareBoxWorld(*game, tasks);
+
+    std::vector<ent_type> ents;
+    ents.reserve(n);
+    const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(n))));
+    for (int i = 0; i < n; ++i) {
+        ent_type e = World::handle(CreateBall(*game));
+        b2Body_SetTransform(World::getComponent<PhysicsBody>(e).body,
+                            {static_cast<float>(i % side) * 5.0f, static_cast<float>(i / side) * 5.0f},
+                            b2Rot_identity);
+        ents.push_back(e);
+    }
+    World::step();
+
+    Measure("physics_system", n, [] { PhysicsSystem(*game, 1.0f / 60.0f); }, [] {});
+
+    DestroyGameEntities(ents);
+}
+
+/** @brief A level of n bricks written to a snapshot file, and the file loaded back (Box2D bodies rebuilt). */
+static void BenchSnapshot(int n, PhysicsTasks& tasks) {
+    MarkHeap();
+    const char* path = "bagel_bench_level.bgsn";
+    CreateLevel(*game, tasks, n / 100, 100);
+
+    Measure("snapshot_save", n, [path] { SaveLevel(*game, path); }, [] {});
+    Measure("snapshot_load", n, [path, &tasks] { LoadLevel(*game, path, tasks); }, [] {});
+    std::remove(path);
+
+    // Every entity, pooled lasers included, goes through DestroySystem
+    std::vector<ent_type> ents;
+    for (bagel::id_type id = 0; id <= World::maxId().id; ++id) {
+        const ent_type e = World::handle(id);
+        if (World::mask(e).ctz() < 0) continue;
+        World::setActive(e, true);
+        ents.push_back(e);
+    }
+    DestroyGameEntities(ents);
+}
+
+/** @brief n interpolated sprites collected into the render batch (no draw call). */
+static void BenchRenderPrep(int n) {
+    MarkHeap();
+    std::vector<ent_type> ents;
+    CreateAll(ents, n);
+    for (ent_type e : ents) {
+        const float x = Random(0.0f, 800.0f), y = Random(0.0f, 600.0f);
+        World::addComponents(e, Position{x, y}, PrevPosition{x - 1.0f, y - 1.0f}, Sprite{eSpriteID::BALL});
+    }
+    World::step();
+
+    SpriteBatch batch;
+    Measure("render_prep", n, [&batch] { PrepareSprites(*game, batch, nullptr, 0.5f); }, [] {});
+    sink = static_cast<float>(batch.size());
+
+    DestroyAll(ents);
+}
+
+//----------------------------------
+/// @section Output
+//----------------------------------
+
+static bool WriteJson(const char* path, const Options& opt) {
+    FILE* f = std::fopen(path, "w");
+    if (f == nullptr) return false;
+    std::fprintf(f, "{\n  \"benchmark\": \"bagel_bench\",\n  \"label\": \"%s\",\n  \"results\": [\n", opt.label);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        // One result per line: Compare() reads the file back line by line
+        std::fprintf(f, "    {\"name\": \"%s\", \"entities\": %d, \"reps\": %d, \"ns_per_entity\": %.3f, "
+                        "\"min_ns_per_entity\": %.3f, \"bytes_per_entity\": %.1f}%s\n",
+                     r.name.c_str(), r.entities, r.reps, r.nsPerEntity, r.minNsPerEntity, r.bytesPerEntity,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+/** @brief Lists the scenarios slower than in the baseline file; returns how many. */
+static int Compare(const char* path, double threshold) {
+    FILE* f = std::fopen(path, "r");
+    if (f == nullptr) {
+        std::fprintf(stderr, "cannot read baseline %s\n", path);
+        return -1;
+    }
+    int regressions = 0;
+    char line[512];
+    while (std::fgets(line, sizeof(line), f) != nullptr) {
+        char name[64];
+        int entities = 0, reps = 0;
+        double base = 0.0;
+        if (std::sscanf(line, " {\"name\": \"%63[^\"]\", \"entities\": %d, \"reps\": %d, \"ns_per_entity\": %lf",
+                        name, &entities, &reps, &base) != 4) continue;
+        for (const Result& r : results) {
+            if (r.name != name || r.entities != entities) continue;
+            if (r.nsPerEntity > base * (1.0 + threshold)) {
+                std::printf("REGRESSION %-24s %8d: %.2f -> %.2f ns/entity (+%.0f%%)\n", name, entities, base,
+                            r.nsPerEntity, (r.nsPerEntity / base - 1.0) * 100.0);
+                ++regressions;
+            }
+        }
+    }
+    std::fclose(f);
+    return regressions;
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--out") == 0 && hasValue) opt.out = argv[++i];
+        else if (std::strcmp(argv[i], "--max") == 0 && hasValue) opt.maxEntities = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--filter") == 0 && hasValue) opt.filter = argv[++i];
+        else if (std::strcmp(argv[i], "--workers") == 0 && hasValue) opt.workers = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--label") == 0 && hasValue) opt.label = argv[++i];
+        else if (std::strcmp(argv[i], "--compare") == 0 && hasValue) opt.compare = argv[++i];
+        else if (std::strcmp(argv[i], "--threshold") == 0 && hasValue) opt.threshold = std::atof(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--out file.json] [--max N] [--filter text] [--workers N] "
+                                 "[--label text] [--compare baseline.json] [--threshold 0.10]\n", argv[0]);
+            return 2;
+        }
+    }
+    options = &opt;
+
+    GameWorld world;
+    World::Bind bind(world.ecs);
+    game = &world;
+
+    bagel::JobSystem jobs(opt.workers > 0 ? opt.workers - 1 : bagel::JobSystem::defaultThreads());
+    PhysicsTasks physicsTasks(jobs);
+
+    std::printf("%-24s %8s %6s %12s %12s %12s\n", "scenario", "entities", "reps", "ns/entity", "min ns/ent",
+                "bytes/entity");
+    for (int n = 1000; n <= opt.maxEntities; n *= 10) {
+        BenchEntities(n);
+        BenchStorage("add_packed", "del_packed", n, Position{1.0f, 2.0f});
+        BenchStorage("add_sparse", "del_sparse", n, Sprite{eSpriteID::BALL});
+        BenchStorage("add_tagged", "del_tagged", n, BallTag{});
+        BenchStorage("add_archetype", "del_archetype", n, bagel::BenchArchetype{1.0f, 2.0f});
+        BenchIteration(n);
+        BenchMovement(n);
+        BenchMovementWorlds(n);
+        BenchCollision(n, physicsTasks);
+        BenchPhysics(n, physicsTasks);
+        BenchRenderPrep(n);
+        BenchSnapshot(n, physicsTasks);
+    }
+
+    if (!WriteJson(opt.out, opt)) {
+        std::fprintf(stderr, "cannot write %s\n", opt.out);
+        return 1;
+    }
+    std::printf("results written to %s\n", opt.out);
+
+    if (opt.compare != nullptr) {
+        const int regressions = Compare(opt.compare, opt.threshold);
+        if (regressions != 0) return 1;
+        std::printf("no regression over %s (threshold %.0f%%)\n", opt.compare, opt.threshold * 100.0);
+    }
+    return 0;
+}
@@ -9,41 +9,197 @@
 
 #include "breakout_game.h"
 #include "../bagel.h"
+#include "../bagel_sched.h"
+#include "../bagel_profile.h"
+#include "../bagel_log.h"
+#include "../bagel_timer.h"
+#include "../bagel_snapshot.h"
+#include "brick_lattice.h"
+#include "sprite_batch.h"
+#include "static_layer.h"
+#include "physics_tasks.h"
+#include "input_log.h"
+#include "game_world.h"
 #include "SDL3_image/SDL_image.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <iostream>
-#include <unordered_map>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <box2d/box2d.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
-/**
- * @brief Specialization of std::hash for breakout::eSpriteID.
- *
- * This allows breakout::eSpriteID to be used as a key in unordered_map or other hash-based containers.
- * It works by casting the enum value to an int and hashing that.
- */
-namespace std {
-    template <>
-    struct hash<breakout::eSpriteID> {
-        size_t operator()(const breakout::eSpriteID& s) const {
-            return hash<int>()(static_cast<int>(s));
-        }
+namespace breakout {
+
+    /** @brief Scheduler resource tag standing for `GameWorld::boxWorld` and the bodies in it. */
+    struct PhysicsWorld {};
+
+    /** @brief Scheduler resource tag standing for `GameWorld::laserPool` and `GameWorld::laserCooldown`. */
+    struct LaserPool {};
+
+    /** @brief Serializes b2CreateWorld / b2DestroyWorld, which update Box2D's global world table. */
+    static std::mutex boxWorldMutex;
+
+    /** @brief Upward laser speed in pixels per second (200 pixels per tick at 60 Hz). */
+    constexpr float LASER_SPEED = -200.0f * 60.0f;
+
+    static bagel::ent_type BuildLaser();
+
+    GameWorld::GameWorld() : laserPool(BuildLaser) {}
+
+    GameWorld::~GameWorld() {
+        std::lock_guard<std::mutex> lock(boxWorldMutex);
+        if (b2World_IsValid(boxWorld)) b2DestroyWorld(boxWorld);
+    }
+
+    /** @brief What a timer in `timers` ends. */
+    enum class eTimer {
+        BREAK_ANIMATION = 0, ///< The brick's break animation is over: destroy it
+        TIMED_EFFECT = 1,    ///< The paddle's power-up runs out
     };
-}
 
-namespace breakout {
+    /** @brief Break animation length (seconds), counted from BreakAnimation::timer. */
+    constexpr float BREAK_ANIMATION_END = 0.555f;
 
-    b2WorldId boxWorld = b2_nullWorldId;
+    /** @brief Starts a timer on `e` that expires after `seconds` (rounded up to whole ticks). */
+    static bagel::TimerWheel::timer_id StartTimer(GameWorld& world, bagel::ent_type e, eTimer kind, float seconds) {
+        const auto ticks = static_cast<bagel::TimerWheel::tick_type>(std::ceil(seconds / world.timerTick - 1e-4f));
+        return world.timers.schedule(e, static_cast<int>(kind), ticks);
+    }
 
     /**
      * @brief Initializes the Box2D physics world with zero gravity.
      *
-     * This function creates a new Box2D world and assigns it to the global `boxWorld` variable.
+     * This function creates a new Box2D world and assigns it to `world.boxWorld`,
+     * destroying the previous one (and its bodies) if any.
      * The gravity is set to (0, 0) since movement is manually controlled.
+     *
+     * @param tasks Runs the solver's tasks on the JobSystem of the ECS systems.
+     * @return false if Box2D has no free world slot (MAX_BOX_WORLDS are alive).
      * */
-    void PrepareBoxWorld() {
+    bool PrepareBoxWorld(GameWorld& world, PhysicsTasks& tasks) {
         b2WorldDef def = b2DefaultWorldDef();
         def.gravity = {0.0f, 0.0f};
-        boxWorld = b2CreateWorld(&def);
+        tasks.configure(def);
+        bool created;
+        {
+            std::lock_guard<std::mutex> lock(boxWorldMutex);
+            if (b2World_IsValid(world.boxWorld)) b2DestroyWorld(world.boxWorld);
+            world.boxWorld = b2CreateWorld(&def);
+            created = b2World_IsValid(world.boxWorld);
+        }
+        world.bodyEntities.clear();
+        if (!created) {
+            world.boxWorld = b2_nullWorldId;
+            BAGEL_LOG_ERROR("Box2D world table full ({} worlds): no physics world for this match", MAX_BOX_WORLDS);
+            return false;
+        }
+        return true;
+    }
+
+    /** @brief Records `e` as the owner of `body` in `bodyEntities`. */
+    static void BindBody(GameWorld& world, b2BodyId body, bagel::ent_type e) {
+        if (body.index1 >= static_cast<int>(world.bodyEntities.size())) {
+            world.bodyEntities.resize(body.index1 + 1, bagel::ent_type{-1});
+        }
+        world.bodyEntities[body.index1] = e;
+    }
+
+    /** @brief Entity owning `body`, or id -1 if none. */
+    static bagel::ent_type BodyEntity(const GameWorld& world, b2BodyId body) {
+        if (body.index1 < 0 || body.index1 >= static_cast<int>(world.bodyEntities.size())) return {-1};
+        return world.bodyEntities[body.index1];
+    }
+
+    /**
+     * @brief Packs an entity handle into Box2D user data, without allocating.
+     *
+     * The id is stored plus one, so null user data (the walls) never maps to an entity.
+     */
+    static void* ToUserData(bagel::ent_type e) {
+        static_assert(sizeof(std::uintptr_t) >= 2 * sizeof(std::uint32_t), "ent_type must fit in a pointer");
+        return reinterpret_cast<void*>(static_cast<std::uintptr_t>(static_cast<std::uint32_t>(e.gen)) << 32 |
+                                       static_cast<std::uint32_t>(e.id + 1));
+    }
+
+    /**
+     * @brief Entity handle packed by ToUserData into the user data of a shape.
+     *
+     * @return The handle, or id -1 for shapes without an entity (walls) or already destroyed.
+     */
+    static bagel::ent_type ShapeEntity(b2ShapeId shape) {
+        if (!b2Shape_IsValid(shape)) return {-1};
+        auto bits = reinterpret_cast<std::uintptr_t>(b2Shape_GetUserData(shape));
+        return {static_cast<bagel::id_type>(static_cast<std::uint32_t>(bits)) - 1,
+                static_cast<bagel::id_type>(bits >> 32)};
+    }
+
+    /**
+     * @brief Creates a Box2D body with a box shape covering the collider of an entity.
+     *
+     * Like the ball, the body origin is the top-left corner of the entity (Position / 10), with
+     * the box offset inside it. The shape user data holds the entity (see ToUserData).
+     *
+     * @param e The entity owning the body.
+     * @param type b2_staticBody, or b2_kinematicBody for bodies moved by the game (the paddle).
+     * @param sensor If true the shape only reports sensor events and does not collide.
+     */
+    static b2BodyId CreateBoxBody(GameWorld& world, bagel::ent_type e, b2BodyType type, const Position& pos,
+                                  const Collider& col, bool sensor = false) {
+        b2BodyDef bodyDef = b2DefaultBodyDef();
+        bodyDef.type = type;
+        bodyDef.position = {pos.x / 10.0f, pos.y / 10.0f};
+        b2BodyId body = b2CreateBody(world.boxWorld, &bodyDef);
+        BindBody(world, body, e);
+
+        b2ShapeDef shapeDef = b2DefaultShapeDef();
+        shapeDef.userData = ToUserData(e);
+        shapeDef.isSensor = sensor;
+        shapeDef.enableSensorEvents = sensor; // opt-in per shape since Box2D 3.1
+        shapeDef.material.friction = 0;
+
+        float hx = col.width / 20.0f, hy = col.height / 20.0f;
+        b2Polygon box = b2MakeOffsetBox(hx, hy, {hx, hy}, b2Rot_identity);
+        b2CreatePolygonShape(body, &shapeDef, &box);
+        return body;
+    }
+
+    /**
+     * @brief Creates the ball's dynamic Box2D body: a circle centered on the sprite, the body
+     * origin being its top-left corner.
+     *
+     * @param position Body origin in meters (Position / 10).
+     * @param velocity Initial linear velocity in meters per second.
+     */
+    static b2BodyId CreateBallBody(GameWorld& world, bagel::ent_type e, const Collider& col, b2Vec2 position,
+                                   b2Vec2 velocity) {
+        b2BodyDef bodyDef = b2DefaultBodyDef();
+        bodyDef.type = b2_dynamicBody;
+        bodyDef.fixedRotation = true;
+        bodyDef.position = position;
+        b2BodyId body = b2CreateBody(world.boxWorld, &bodyDef);
+
+        b2ShapeDef ballShapeDef = b2DefaultShapeDef();
+        ballShapeDef.enableSensorEvents = true;
+        ballShapeDef.density = 1;
+        ballShapeDef.material.friction = 0;
+        ballShapeDef.material.restitution = 1.0f; // the ball became too quick
+
+        ballShapeDef.userData = ToUserData(e);
+
+        b2Circle circle = {{col.width / 20.0f, col.height / 20.0f},
+                           (87.0f * 0.4f / 2.0f) / 10.0f}; // radius in meters
+        b2CreateCircleShape(body, &ballShapeDef, &circle);
+
+        b2Body_SetLinearVelocity(body, velocity);
+        BindBody(world, body, e);
+        return body;
     }
 
     //----------------------------------
@@ -54,17 +210,22 @@ namespace breakout {
      * @brief Creates a full grid of bricks arranged in rows and columns.
      *        In the center of the top row, a star power-up is placed instead of a brick.
      *
+     * Every created entity is indexed in `brickLattice` and tagged with LatticeTag.
+     *
      * @param rows Number of brick rows
      * @param cols Number of bricks per row
      * @param health Health value assigned to each brick
      */
-    void CreateBrickGrid(int rows, int cols, int health) {
+    void CreateBrickGrid(GameWorld& world, int rows, int cols, int health) {
+        bagel::World::Bind bind(world.ecs);
         const float brickW = 120.0f, brickH = 40.0f;
         const float spacingX = 5.0f, spacingY = 5.0f;
         float totalWidth = cols * brickW + (cols - 1) * spacingX;
         float startX = (800.0f - totalWidth) / 2.0f;
         float startY = 80.0f;
 
+        world.brickLattice.configure(startX, startY, brickW + spacingX, brickH + spacingY, rows, cols);
+
         for (int row = 0; row < rows; ++row) {
             for (int col = 0; col < cols; ++col) {
                 float x = startX + col * (brickW + spacingX);
@@ -72,21 +233,31 @@ namespace breakout {
                 eSpriteID color = static_cast<eSpriteID>(2 + (row % 4) * 2); // Choose color by row
 
                 // Place the star and the heart
+                id_type id;
                 if (row == 1 && col == 1) {
-                    CreateStar(x, y);
+                    id = CreateStar(world, x, y);
                 }
                 else if (row == 2 && col == cols - 2) {
-                    CreateHeart(x, y);
+                    id = CreateHeart(world, x, y);
                 }
                 else {
-                    CreateBrick(health, color, x, y);
+                    id = CreateBrick(world, health, color, x, y);
                 }
+
+                bagel::ent_type e = bagel::World::handle(id);
+
+                bagel::World::addComponent(e, LatticeTag{});
+                world.brickLattice.place(row, col, e, MakeAABB(bagel::World::getComponent<Position>(e),
+                                                               bagel::World::getComponent<Collider>(e)));
             }
         }
     }
 
+    /** @brief Number of eSpriteID values. */
+    constexpr int SPRITE_COUNT = static_cast<int>(eSpriteID::HEART) + 1;
+
     /**
-     * @brief Sprite atlas mapping each eSpriteID to its rectangle in the sprite sheet.
+     * @brief Sprite atlas: the rectangle of each eSpriteID in the sprite sheet, indexed by the enum value.
      *
      * Each entry defines the source rectangle (x, y, width, height) of the sprite
      * within the shared texture atlas. These coordinates are used during rendering
@@ -94,22 +265,79 @@ namespace breakout {
      *
      * Units are in pixels and refer to positions inside the texture image.
      */
-    static const std::unordered_map<eSpriteID, SDL_FRect> SPRITE_ATLAS = {
-            {eSpriteID::BALL, {800, 548, 87, 77}},
-            {eSpriteID::PADDLE, {392, 9, 161, 55}},
-            {eSpriteID::BRICK_BLUE, {21, 17, 171, 59}},
-            {eSpriteID::BRICK_BLUE_DMG, {209, 16, 171, 60}},
-            {eSpriteID::BRICK_PURPLE, {20, 169, 168, 57}},
-            {eSpriteID::BRICK_PURPLE_DMG, {208, 168, 170, 58}},
-            {eSpriteID::BRICK_YELLOW, {20, 469, 169, 59}},
-            {eSpriteID::BRICK_YELLOW_DMG, {210, 470, 166, 63}},
-            {eSpriteID::BRICK_ORANGE, {17, 319, 175, 57}},
-            {eSpriteID::BRICK_ORANGE_DMG, {206, 318, 175, 58}},
-            {eSpriteID::LASER, {837, 643, 11, 22}},
-            {eSpriteID::STAR, {798, 372, 84, 73}},
-            {eSpriteID::HEART, {804, 461, 79, 70}},
+    static const SDL_FRect SPRITE_ATLAS[SPRITE_COUNT] = {
+            {800, 548, 87, 77},     // BALL
+            {392, 9, 161, 55},      // PADDLE
+            {21, 17, 171, 59},      // BRICK_BLUE
+            {209, 16, 171, 60},     // BRICK_BLUE_DMG
+            {20, 169, 168, 57},     // BRICK_PURPLE
+            {208, 168, 170, 58},    // BRICK_PURPLE_DMG
+            {20, 469, 169, 59},     // BRICK_YELLOW
+            {210, 470, 166, 63},    // BRICK_YELLOW_DMG
+            {17, 319, 175, 57},     // BRICK_ORANGE
+            {206, 318, 175, 58},    // BRICK_ORANGE_DMG
+            {837, 643, 11, 22},     // LASER
+            {798, 372, 84, 73},     // STAR
+            {804, 461, 79, 70},     // HEART
     };
 
+    /** @brief Render data of a sprite: texture coordinates and on-screen size. */
+    struct SpriteFrame {
+        SpriteUV uv;
+        float w = 0.0f;
+        float h = 0.0f;
+    };
+
+    /**
+     * @brief On-screen size of a sprite: 0.7 of its sheet size, 0.4 for the ball.
+     */
+    static SDL_FPoint SpriteSize(eSpriteID id) {
+        const SDL_FRect& src = SPRITE_ATLAS[static_cast<int>(id)];
+        float scale = id == eSpriteID::BALL ? 0.4f : 0.7f;
+        return {src.w * scale, src.h * scale};
+    }
+
+    /**
+     * @brief Returns the render data of every sprite, indexed by eSpriteID.
+     *
+     * Computed from SPRITE_ATLAS and the sheet size on the first call for a texture.
+     */
+    static const SpriteFrame* GetSpriteFrames(SDL_Texture* tex) {
+        static SpriteFrame frames[SPRITE_COUNT];
+        static SDL_Texture* framesTex = nullptr;
+
+        if (framesTex != tex) {
+            float sheetW = 1.0f, sheetH = 1.0f;
+            SDL_GetTextureSize(tex, &sheetW, &sheetH);
+            for (int i = 0; i < SPRITE_COUNT; ++i) {
+                SDL_FPoint size = SpriteSize(static_cast<eSpriteID>(i));
+                frames[i] = {MakeUV(SPRITE_ATLAS[i], sheetW, sheetH), size.x, size.y};
+            }
+            framesTex = tex;
+        }
+        return frames;
+    }
+
+    /**
+     * @brief Whether an entity is drawn through `brickLayer`: the bricks of the brick grid,
+     * which never move.
+     */
+    static bool IsLayerBrick(const bagel::Mask& mask) {
+        return mask.test(bagel::Component<LatticeTag>::Bit) && mask.test(bagel::Component<BrickHealth>::Bit);
+    }
+
+    /**
+     * @brief Marks the area of a brick sprite in `brickLayer` for redrawing.
+     *
+     * @param e The brick entity.
+     * @param spriteID The sprite drawn there (called for both the old and the new sprite on change).
+     */
+    static void InvalidateBrick(GameWorld& world, bagel::ent_type e, eSpriteID spriteID) {
+        const auto& pos = bagel::World::readComponent<Position>(e);
+        SDL_FPoint size = SpriteSize(spriteID);
+        world.brickLayer.invalidate({pos.x, pos.y, size.x, size.y});
+    }
+
     /**
      * @brief Returns the "damaged" version of a brick sprite.
      *
@@ -160,240 +388,268 @@ namespace breakout {
     //----------------------------------
 
     /**
-    * @brief Handles timing of break animations and destroys the entity when the animation is complete.
+    * @brief Advances `timers` by one tick and handles the timers that expire on it.
     *
-    * Any entity with a BreakAnimation component will have its timer incremented each frame.
-    * Once the timer exceeds 0.555 seconds, the entity is marked for destruction (if not already).
+    * - BREAK_ANIMATION: the brick's animation is complete; it is marked for destruction.
+    * - TIMED_EFFECT: the paddle's power-up runs out; its components are removed and the
+    *   paddle size is restored after WIDE_PADDLE.
     *
-    * @param deltaTime Time since last frame (in seconds)
+    * Notes:
+    * - Timers of entities that were destroyed meanwhile are ignored.
+    * - A power-up collected while another is on replaces the TimedEffect; the replaced effect's
+    *   timer is recognized by its id no longer matching TimedEffect::timer and is ignored.
+    * - Structural changes are recorded in the thread's CommandBuffer and applied by World::step().
     */
-    void BreakAnimationSystem(float deltaTime) {
-        bagel::Mask breakMask;
-        breakMask.set(bagel::Component<BreakAnimation>::Bit);
-
-        for (bagel::id_type id = 0; id <= bagel::World::maxId().id; ++id) {
-            bagel::ent_type entity{id};
-            if (!bagel::World::mask(entity).test(breakMask)) continue;
-            if (bagel::World::mask(entity).test(bagel::Component<DestroyedTag>::Bit)) continue;
-
-            auto& anim = bagel::World::getComponent<BreakAnimation>(entity);
-            anim.timer += deltaTime;
+    void TimerSystem(GameWorld& world) {
+        using namespace bagel;
+        World::Bind bind(world.ecs);
+        CommandBuffer& cmd = CommandBuffer::local();
+
+        world.timers.advance([&cmd](ent_type ent, int kind, TimerWheel::timer_id id) {
+            if (!World::isAlive(ent)) return;
+            const Mask& mask = World::mask(ent);
+            if (mask.test(Component<DestroyedTag>::Bit)) return;
+
+            switch (static_cast<eTimer>(kind)) {
+            case eTimer::BREAK_ANIMATION:
+                cmd.add(ent, breakout::DestroyedTag{});
+                break;
+
+            case eTimer::TIMED_EFFECT:
+                if (!mask.test(Component<TimedEffect>::Bit) || World::getComponent<TimedEffect>(ent).timer != id)
+                    return;
+                BAGEL_LOG_INFO("Power-up expired.");
+
+                if (World::getComponent<PowerUpType>(ent).powerUp == breakout::ePowerUpType::WIDE_PADDLE) {
+                    if (mask.test(Component<Collider>::Bit)) {
+                        auto& col = World::getComponent<Collider>(ent);
+                        col.width = 100.0f; // Reset paddle width
+                        BAGEL_LOG_INFO("Paddle size restored.");
+                    }
+                }
 
-            if (anim.timer >= 0.555f) {
-                bagel::World::addComponent(entity, breakout::DestroyedTag{});
+                cmd.del<PowerUpType>(ent);
+                cmd.del<TimedEffect>(ent);
+                break;
             }
-        }
+        });
     }
 
     /**
-     * @brief Updates positions of entities that have both Position and Velocity components.
+     * @brief Adds scaled src to dst element-wise: dst[i] += src[i] * k for n floats.
      *
-     * This system moves all entities based on their Velocity and handles collision with
-     * Checks for laser entities that move outside the top of the screen and marks them for destruction.
+     * Uses AVX when the build enables it (BAGEL_AVX2), SSE otherwise on x86-64,
+     * and a scalar loop for the remainder or on other targets.
      */
-    void MovementSystem() {
-        bagel::Mask required;
-        required.set(bagel::Component<Position>::Bit);
-        required.set(bagel::Component<Velocity>::Bit);
-
-        constexpr float SCREEN_WIDTH = 800.0f;
+    static void AddScaledFloats(float* dst, const float* src, float k, int n) {
+        int i = 0;
+#if defined(__AVX__)
+        const __m256 k8 = _mm256_set1_ps(k);
+        for (; i + 8 <= n; i += 8) {
+            __m256 d = _mm256_loadu_ps(dst + i);
+            _mm256_storeu_ps(dst + i, _mm256_add_ps(d, _mm256_mul_ps(_mm256_loadu_ps(src + i), k8)));
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128 k4 = _mm_set1_ps(k);
+        for (; i + 4 <= n; i += 4) {
+            __m128 d = _mm_loadu_ps(dst + i);
+            _mm_storeu_ps(dst + i, _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(src + i), k4)));
+        }
+#endif
+        for (; i < n; ++i) {
+            dst[i] += src[i] * k;
+        }
+    }
 
-        for (bagel::id_type id = 0; id <= bagel::World::maxId().id; ++id) {
-            bagel::ent_type ent{id};
+    /**
+     * @brief Saves the current Position of every entity that has a PrevPosition.
+     *
+     * Runs first in every simulation tick, so RenderSystem can interpolate between the
+     * previous and the current tick.
+     */
+    void PrevPositionSystem(GameWorld& world) {
+        bagel::World::Bind bind(world.ecs);
+        using PrevView = bagel::View<bagel::Include<PrevPosition, Position>>;
 
-            if (!bagel::World::mask(ent).test(required)) continue;
+        for (bagel::ent_type ent : PrevView{}) {
+            const auto& pos = bagel::World::readComponent<Position>(ent);
+            bagel::World::getComponent<PrevPosition>(ent) = {pos.x, pos.y};
+        }
+    }
 
-            // Skip entities marked for destruction
-            if (bagel::World::mask(ent).test(bagel::Component<DestroyedTag>::Bit)) continue;
+    /**
+     * @brief Updates positions of entities that have both Position and Velocity components.
+     *
+     * Position and Velocity are owned by a bagel::Group, so the first Group::size() rows of
+     * both storages belong to the same entities in the same order. `pos += vel * deltaTime`
+     * therefore runs as one SIMD loop over the two flat float arrays.
+     * Afterwards, laser entities that moved outside the top of the screen are stopped and
+     * returned to `laserPool` (deferred through the thread's CommandBuffer). Inactive lasers
+     * are still rows of the group, parked with zero velocity.
+     *
+     * @param deltaTime Simulation time step (seconds); velocities are in pixels per second.
+     */
+    void MovementSystem(GameWorld& world, float deltaTime) {
+        bagel::World::Bind bind(world.ecs);
+        using MoveGroup = bagel::Group<Position, Velocity>;
+        static_assert(sizeof(Position) == 2 * sizeof(float) && sizeof(Velocity) == 2 * sizeof(float),
+                      "MovementSystem treats Position/Velocity rows as float pairs");
+        bagel::CommandBuffer& cmd = bagel::CommandBuffer::local();
 
-            auto& pos = bagel::World::getComponent<Position>(ent);
-            auto& vel = bagel::World::getComponent<Velocity>(ent);
-            auto& collider = bagel::World::getComponent<Collider>(ent);
+        // Move entities
+        AddScaledFloats(&MoveGroup::data<Position>()->x, &MoveGroup::data<Velocity>()->dx, deltaTime,
+                        2 * MoveGroup::size());
 
-            // Move entity
-            pos.x += vel.dx;
-            pos.y += vel.dy;
+        for (bagel::index_type i = 0; i < MoveGroup::size(); ++i) {
+            bagel::ent_type ent = MoveGroup::entity(i);
+            const bagel::Mask& mask = bagel::World::mask(ent);
 
             // Check if it's a laser that moved off-screen (above)
-            if (bagel::World::mask(ent).test(bagel::Component<LaserTag>::Bit)) {
-                if (pos.y + collider.height < 0) {
-                    bagel::World::addComponent(ent, breakout::DestroyedTag{});
-                    continue;
-                }
+            if (!mask.test(bagel::Component<LaserTag>::Bit)) continue;
+            if (mask.test(bagel::Component<DestroyedTag>::Bit)) continue;
+            if (!bagel::World::isActive(ent)) continue;
+
+            const auto& pos = bagel::World::readComponent<Position>(ent);
+            const auto& collider = bagel::World::readComponent<Collider>(ent);
+            if (pos.y + collider.height < 0) {
+                cmd.add(ent, breakout::Velocity{});
+                world.laserPool.release(cmd, ent);
             }
         }
     }
 
+    /**
+     * @brief Applies one hit to a brick: when its health runs out it shows its damaged sprite,
+     * stops colliding and starts its BreakAnimation.
+     */
+    static void HitBrick(GameWorld& world, bagel::CommandBuffer& cmd, bagel::ent_type brick) {
+        auto& health = bagel::World::getComponent<BrickHealth>(brick);
+        health.hits--;
+        if (health.hits > 0) return;
+
+        auto& sprite = bagel::World::getComponent<Sprite>(brick);
+        InvalidateBrick(world, brick, sprite.spriteID);
+        sprite.spriteID = getBrokenVersion(sprite.spriteID);
+        InvalidateBrick(world, brick, sprite.spriteID);
+
+        // The ball passes through a broken brick while it animates
+        b2Body_Disable(bagel::World::getComponent<PhysicsBody>(brick).body);
+
+        if (!bagel::World::mask(brick).test(bagel::Component<BreakAnimation>::Bit)) {
+            cmd.add(brick, breakout::BreakAnimation{0.5f});
+            StartTimer(world, brick, eTimer::BREAK_ANIMATION, BREAK_ANIMATION_END - 0.5f);
+        }
+    }
+
+    /**
+     * @brief Grants a power-up to the (first) paddle and marks the collected power-up entity destroyed.
+     */
+    static void CollectPowerUp(GameWorld& world, bagel::CommandBuffer& cmd, bagel::ent_type item, ePowerUpType type,
+                               float duration) {
+        for (bagel::ent_type paddle : bagel::View<bagel::Include<PaddleControl>>{}) {
+            cmd.add(paddle, breakout::PowerUpType{type});
+            cmd.add(paddle, breakout::TimedEffect{duration, StartTimer(world, paddle, eTimer::TIMED_EFFECT, duration)});
+            break;
+        }
+        cmd.add(item, breakout::DestroyedTag{});
+    }
+
     /**
     * @brief Detects and handles collisions between entities in the game world.
     *
-    * This system checks for collisions between entities that have both Position and Collider components.
     * It supports the following interaction types:
     * - Laser vs Brick: decreases brick health, adds BreakAnimation, marks brick for destruction.
-    * - Ball vs Brick: same as laser, with bounce effect.
-    * - Ball vs Paddle: inverts Y velocity of the ball.
+    * - Ball vs Brick: same as laser.
+    * - Ball vs Paddle: nothing to do, Box2D bounces the ball.
     * - Ball vs Floor: marks the ball for destruction.
     * - Ball vs Star: gives laser power-up to paddle and destroys the star.
     * - Ball vs Heart: gives wide paddle power-up to paddle and destroys the heart.
     *
     * Notes:
+    * - Runs after PhysicsSystem. Ball collisions are not searched for: they are the begin-touch
+    *   contact events of the last b2World_Step (bricks, paddle, star, heart) and its sensor events
+    *   (floor), mapped back to entities through the shape user data. Box2D already bounced the
+    *   ball, so the work per tick is proportional to the contacts that actually happened.
+    * - Broad phase: lasers have no Box2D body, so each one queries `brickLattice` (constant
+    *   time, static bricks and power-ups only) and runs an AABB test against the candidates;
+    *   balls get their candidate pairs from Box2D's broad phase.
     * - Entities marked with DestroyedTag are skipped.
-    * - Collision detection is axis-aligned bounding box (AABB).
+    * - Structural changes (BreakAnimation, DestroyedTag, power-ups) are recorded in the thread's
+    *   CommandBuffer and applied by World::step(), so masks and storages stay stable while iterating.
     *
     * Requirements:
     * - Components: Position, Collider
     */
-    void CollisionSystem() {
-        bagel::Mask requiredMask;
-        requiredMask.set(bagel::Component<Position>::Bit);
-        requiredMask.set(bagel::Component<Collider>::Bit);
-
-        for (bagel::id_type id1 = 0; id1 <= bagel::World::maxId().id; ++id1) {
-            bagel::ent_type e1{id1};
-            if (!bagel::World::mask(e1).test(requiredMask)) continue;
-
-            // ====== Laser vs Brick ======
-            if (bagel::World::mask(e1).test(bagel::Component<LaserTag>::Bit)) {
-                for (bagel::id_type id2 = 0; id2 <= bagel::World::maxId().id; ++id2) {
-                    if (id1 == id2) continue;
-
-                    bagel::ent_type e2{id2};
-                    if (!bagel::World::mask(e2).test(requiredMask)) continue;
-                    if (!bagel::World::mask(e2).test(bagel::Component<BrickHealth>::Bit)) continue;
-                    if (bagel::World::mask(e2).test(bagel::Component<DestroyedTag>::Bit)) continue;
-
-                    auto& p1 = bagel::World::getComponent<Position>(e1);
-                    auto& c1 = bagel::World::getComponent<Collider>(e1);
-                    auto& p2 = bagel::World::getComponent<Position>(e2);
-                    auto& c2 = bagel::World::getComponent<Collider>(e2);
-
-                    if (!isColliding(p1, c1, p2, c2)) continue;
-
-                    std::cout << "Laser hit brick!\n";
-
-                    auto& brick = bagel::World::getComponent<BrickHealth>(e2);
-                    if (brick.hits <= 0) continue;
-                    brick.hits--;
-
-                    if (brick.hits <= 0) {
-                        auto& sprite = bagel::World::getComponent<Sprite>(e2);
-                        sprite.spriteID = getBrokenVersion(sprite.spriteID);
-
-                        if (!bagel::World::mask(e2).test(bagel::Component<BreakAnimation>::Bit)) {
-                            bagel::World::addComponent(e2, breakout::BreakAnimation{0.5f});
-                        }
-                    }
-                }
-                continue;
+    void CollisionSystem(GameWorld& world) {
+        using namespace bagel;
+        using LaserView = View<Include<LaserTag, Velocity, Position, Collider>>;
+
+        World::Bind bind(world.ecs);
+        CommandBuffer& cmd = CommandBuffer::local();
+        std::vector<ent_type>& candidates = world.candidates;
+
+        // ====== Laser vs Brick ======
+        for (ent_type e1 : LaserView{}) {
+            const auto& p1 = World::readComponent<Position>(e1);
+            const auto& c1 = World::readComponent<Collider>(e1);
+            world.brickLattice.queryAABB(MakeAABB(p1, c1), candidates);
+
+            for (ent_type e2 : candidates) {
+                if (!World::mask(e2).test(Component<BrickHealth>::Bit)) continue;
+                if (World::mask(e2).test(Component<DestroyedTag>::Bit)) continue;
+                if (!isColliding(p1, c1, World::getComponent<Position>(e2), World::getComponent<Collider>(e2))) continue;
+                if (World::getComponent<BrickHealth>(e2).hits <= 0) continue;
+
+                BAGEL_LOG_DEBUG("Laser hit brick!");
+                HitBrick(world, cmd, e2);
             }
+        }
 
-            // ====== Ball collisions ======
-            if (!bagel::World::mask(e1).test(bagel::Component<BallTag>::Bit)) continue;
-
-            for (bagel::id_type id2 = 0; id2 <= bagel::World::maxId().id; ++id2) {
-                if (id1 == id2) continue;
-
-                bagel::ent_type e2{id2};
-                if (!bagel::World::mask(e2).test(requiredMask)) continue;
-                if (bagel::World::mask(e2).test(bagel::Component<DestroyedTag>::Bit)) continue;
-
-                auto& p1 = bagel::World::getComponent<Position>(e1);
-                auto& c1 = bagel::World::getComponent<Collider>(e1);
-                auto& p2 = bagel::World::getComponent<Position>(e2);
-                auto& c2 = bagel::World::getComponent<Collider>(e2);
-
-                if (!isColliding(p1, c1, p2, c2)) continue;
-
-                // --- Ball hits Brick ---
-                if (bagel::World::mask(e2).test(bagel::Component<BrickHealth>::Bit)) {
-                    auto& brick = bagel::World::getComponent<BrickHealth>(e2);
-                    if (brick.hits <= 0) continue;
-
-                    std::cout << "Ball hit brick! Entity: " << e2.id
-                              << ", Remaining hits: " << brick.hits << "\n";
-
-                    brick.hits--;
-
-                    auto& vel = bagel::World::getComponent<Velocity>(e1);
-                    vel.dy *= -1;
-
-                    if (brick.hits <= 0) {
-                        auto& sprite = bagel::World::getComponent<Sprite>(e2);
-                        sprite.spriteID = getBrokenVersion(sprite.spriteID);
-
-                        if (!bagel::World::mask(e2).test(bagel::Component<BreakAnimation>::Bit)) {
-                            bagel::World::addComponent(e2, breakout::BreakAnimation{0.5f});
-                        }
-                    }
+        // ====== Ball vs Brick / Paddle / Star / Heart (contact events) ======
+        b2ContactEvents contacts = b2World_GetContactEvents(world.boxWorld);
+        for (int i = 0; i < contacts.beginCount; ++i) {
+            ent_type ball = ShapeEntity(contacts.beginEvents[i].shapeIdA);
+            ent_type other = ShapeEntity(contacts.beginEvents[i].shapeIdB);
+            if (!World::isAlive(ball) || !World::isAlive(other)) continue;
+            if (!World::mask(ball).test(Component<BallTag>::Bit)) std::swap(ball, other);
+            if (!World::mask(ball).test(Component<BallTag>::Bit)) continue;
 
-                    auto& phys = bagel::World::getComponent<PhysicsBody>(e1);
-                    b2Vec2 v = b2Body_GetLinearVelocity(phys.body);
-                    v.y *= -1;
-                    b2Body_SetLinearVelocity(phys.body, v);
-                    break;
-                }
+            const Mask& mask = World::mask(other);
+            if (mask.test(Component<DestroyedTag>::Bit)) continue;
 
-                // --- Ball hits Paddle ---
-                if (bagel::World::mask(e2).test(bagel::Component<PaddleControl>::Bit)) {
-                    std::cout << "Ball hit paddle! Inverting Y velocity.\n";
-                    auto& phys = bagel::World::getComponent<PhysicsBody>(e1);
-                    b2Vec2 v = b2Body_GetLinearVelocity(phys.body);
-                    v.y = -std::abs(v.y);
-                    b2Body_SetLinearVelocity(phys.body, v);
-                    break;
-                }
+            if (mask.test(Component<BrickHealth>::Bit)) {
+                auto& brick = World::getComponent<BrickHealth>(other);
+                if (brick.hits <= 0) continue;
 
-                // --- Ball hits Floor ---
-                if (bagel::World::mask(e2).test(bagel::Component<FloorTag>::Bit)) {
-                    std::cout << "Ball hit the floor!\n";
-                    if (!bagel::World::mask(e1).test(bagel::Component<DestroyedTag>::Bit)) {
-                        bagel::World::addComponent(e1, breakout::DestroyedTag{});
-                    }
-                    break;
-                }
-
-                // --- Ball hits Star ---
-                if (bagel::World::mask(e2).test(bagel::Component<StarPowerTag>::Bit)) {
-                    std::cout << "Ball hit star! Paddle gains laser power.\n";
-
-                    for (bagel::id_type pid = 0; pid <= bagel::World::maxId().id; ++pid) {
-                        bagel::ent_type paddle{pid};
-                        if (bagel::World::mask(paddle).test(bagel::Component<PaddleControl>::Bit)) {
-                            bagel::World::addComponent(paddle, breakout::PowerUpType{ePowerUpType::SHOOTING_LASER});
-                            bagel::World::addComponent(paddle, breakout::TimedEffect{0.8f});
-                            break;
-                        }
-                    }
-
-                    bagel::World::addComponent(e2, breakout::DestroyedTag{});
-                    auto& phys = bagel::World::getComponent<PhysicsBody>(e1);
-                    b2Vec2 v = b2Body_GetLinearVelocity(phys.body);
-                    v.y *= -1;
-                    b2Body_SetLinearVelocity(phys.body, v);
-                    break;
-                }
-
-                // --- Ball hits Heart ---
-                if (bagel::World::mask(e2).test(bagel::Component<HeartPowerTag>::Bit)) {
-                    std::cout << "Ball hit heart! Paddle becomes wider.\n";
-
-                    for (bagel::id_type pid = 0; pid <= bagel::World::maxId().id; ++pid) {
-                        bagel::ent_type paddle{pid};
-                        if (bagel::World::mask(paddle).test(bagel::Component<PaddleControl>::Bit)) {
-                            bagel::World::addComponent(paddle, breakout::PowerUpType{breakout::ePowerUpType::WIDE_PADDLE});
-                            bagel::World::addComponent(paddle, breakout::TimedEffect{3.0f});
-                            break;
-                        }
-                    }
-
-                    bagel::World::addComponent(e2, breakout::DestroyedTag{});
-                    auto& phys = bagel::World::getComponent<PhysicsBody>(e1);
-                    b2Vec2 v = b2Body_GetLinearVelocity(phys.body);
-                    v.y *= -1;
-                    b2Body_SetLinearVelocity(phys.body, v);
-                    break;
-                }
+                BAGEL_LOG_INFO("Ball hit brick! Entity: {}, Remaining hits: {}", other.id, brick.hits);
+                HitBrick(world, cmd, other);
+            }
+            else if (mask.test(Component<PaddleControl>::Bit)) {
+                BAGEL_LOG_DEBUG("Ball hit paddle!");
+            }
+            else if (mask.test(Component<StarPowerTag>::Bit)) {
+                BAGEL_LOG_INFO("Ball hit star! Paddle gains laser power.");
+                CollectPowerUp(world, cmd, other, ePowerUpType::SHOOTING_LASER, 0.8f);
             }
+            else if (mask.test(Component<HeartPowerTag>::Bit)) {
+                BAGEL_LOG_INFO("Ball hit heart! Paddle becomes wider.");
+                CollectPowerUp(world, cmd, other, ePowerUpType::WIDE_PADDLE, 3.0f);
+            }
+        }
+
+        // ====== Ball vs Floor (sensor events) ======
+        b2SensorEvents sensors = b2World_GetSensorEvents(world.boxWorld);
+        for (int i = 0; i < sensors.beginCount; ++i) {
+            ent_type floor = ShapeEntity(sensors.beginEvents[i].sensorShapeId);
+            ent_type ball = ShapeEntity(sensors.beginEvents[i].visitorShapeId);
+            if (!World::isAlive(floor) || !World::isAlive(ball)) continue;
+            if (!World::mask(floor).test(Component<FloorTag>::Bit)) continue;
+            if (!World::mask(ball).test(Component<BallTag>::Bit)) continue;
+            if (World::mask(ball).test(Component<DestroyedTag>::Bit)) continue;
+
+            BAGEL_LOG_INFO("Ball hit the floor!");
+            cmd.add(ball, breakout::DestroyedTag{});
         }
     }
 
@@ -401,84 +657,107 @@ namespace breakout {
      * @brief Handles keyboard input and updates paddle position accordingly.
      *
      * This system iterates over all entities that have both Position and PaddleControl components,
-     * reads the current state of the keyboard, and moves paddles left or right based on the
+     * reads the given keyboard state, and moves paddles left or right based on the
      * corresponding key bindings.
      *
      * The paddle's horizontal position is clamped to ensure it stays within the screen bounds.
+     * A paddle with a kinematic body is moved by giving the body the velocity that reaches the
+     * target in one step, so the solver sees it move (a teleport could put it into or through
+     * the ball); its Position follows from the step's move events, like any other body.
      *
      * Requirements:
      * - Components: Position, PaddleControl
      *
+     * @param keys Key states indexed by SDL_Scancode (SDL_GetKeyboardState, or scripted input
+     *             when running headless).
+     *
+     * @param deltaTime Simulation time step (seconds).
+     *
      * Notes:
-     * - Uses SDL_GetKeyboardState to access current key states.
      * - Assumes paddle width is 161 * 0.7f and screen width is 800.
      */
-    void PlayerControlSystem() {
+    void PlayerControlSystem(GameWorld& world, const bool* keys, float deltaTime) {
         constexpr float SCREEN_WIDTH = 800.0f;
-        constexpr float MAX_SPEED = 6.0f; // adjust as needed
+        constexpr float MAX_SPEED = 360.0f; // pixels per second, adjust as needed
 
-        bagel::Mask mask;
-        mask.set(bagel::Component<PaddleControl>::Bit);
-        mask.set(bagel::Component<Position>::Bit);
-        mask.set(bagel::Component<Collider>::Bit);
+        using PaddleView = bagel::View<bagel::Include<PaddleControl, Position, Collider>>;
 
-        SDL_PumpEvents();
-        const bool* keys = SDL_GetKeyboardState(nullptr);
-
-        for (bagel::id_type id = 0; id <= bagel::World::maxId().id; ++id) {
-            bagel::ent_type ent{id};
-            if (!bagel::World::mask(ent).test(mask)) continue;
-
-            const auto& control = bagel::World::getComponent<PaddleControl>(ent);
-            auto& pos = bagel::World::getComponent<Position>(ent);
-            const auto& col = bagel::World::getComponent<Collider>(ent);
+        bagel::World::Bind bind(world.ecs);
+        for (bagel::ent_type ent : PaddleView{}) {
+            const auto& control = bagel::World::readComponent<PaddleControl>(ent);
+            const auto& pos = bagel::World::readComponent<Position>(ent);
+            const auto& col = bagel::World::readComponent<Collider>(ent);
 
             float vx = 0.0f;
             if (keys[control.keyLeft])  vx -= MAX_SPEED;
             if (keys[control.keyRight]) vx += MAX_SPEED;
 
-            pos.x += vx;
-
             // Clamp to screen bounds
-            if (pos.x < 0) pos.x = 0;
-            if (pos.x + col.width > SCREEN_WIDTH)
-                pos.x = SCREEN_WIDTH - col.width;
+            float x = pos.x + vx * deltaTime;
+            if (x < 0) x = 0;
+            if (x + col.width > SCREEN_WIDTH)
+                x = SCREEN_WIDTH - col.width;
+
+            // Drive the kinematic body there during the step (pixels to meters, scale = 10)
+            if (bagel::World::mask(ent).test(bagel::Component<PhysicsBody>::Bit)) {
+                b2Body_SetLinearVelocity(bagel::World::readComponent<PhysicsBody>(ent).body,
+                                         {(x - pos.x) / deltaTime / 10.0f, 0.0f});
+            }
+            else {
+                bagel::World::getComponent<Position>(ent).x = x;
+            }
         }
     }
 
     /**
-    * @brief For each entity with PhysicsBody + Position, sync the position from Box2D.
+    * @brief Steps the Box2D world by one simulation tick, then syncs Position from Box2D
+    * for the bodies that moved, as reported by the step's move events.
+    *
+    * Bodies are mapped back to entities through `bodyEntities`, so the cost scales with the
+    * number of moving bodies rather than with every entity that has a PhysicsBody.
+    *
+    * @param deltaTime Simulation time step (seconds).
     */
-    void PhysicsSystem(float deltaTime) {
+    void PhysicsSystem(GameWorld& world, float deltaTime) {
         using namespace bagel;
-
-        constexpr float BOX_STEP = 1.0f / 60.0f;
+        World::Bind bind(world.ecs);
 
         // Step the Box2D world
-        b2World_Step(boxWorld, BOX_STEP, 8);
-
-        bagel::Mask mask;
-        mask.set(Component<PhysicsBody>::Bit);
-        mask.set(Component<Position>::Bit);
-
-        for (id_type id = 0; id <= World::maxId().id; ++id) {
-            ent_type ent{id};
+        {
+            BAGEL_ZONE("b2World_Step");
+            b2World_Step(world.boxWorld, deltaTime, 8);
+        }
 
-            if (!World::mask(ent).test(mask)) continue;
+        // Only bodies the solver moved are reported (not asleep or static ones); the paddle is
+        // among them while PlayerControlSystem gives it a velocity
+        b2BodyEvents events = b2World_GetBodyEvents(world.boxWorld);
+        for (int i = 0; i < events.moveCount; ++i) {
+            const b2BodyMoveEvent& move = events.moveEvents[i];
+            ent_type ent = BodyEntity(world, move.bodyId);
+            if (!World::isAlive(ent) || !World::mask(ent).test(Component<Position>::Bit)) continue;
 
-            auto& phys = World::getComponent<PhysicsBody>(ent);
+            // Convert from meters to pixels (scale = 10)
             auto& pos = World::getComponent<Position>(ent);
+            pos.x = move.transform.p.x * 10.0f;
+            pos.y = move.transform.p.y * 10.0f;
+        }
+    }
 
-            // Safety check
-            if (!b2Body_IsValid(phys.body)) continue;
-
-            // Get transform from Box2D
-            b2Transform t = b2Body_GetTransform(phys.body);
-
-            // Convert from meters to pixels (scale = 10)
-            pos.x = t.p.x * 10.0f;
-            pos.y = t.p.y * 10.0f;
+    /**
+     * @brief Fires a laser from `laserPool`: records its activation and its new position and
+     * velocity in a CommandBuffer (value updates only, no structural change).
+     *
+     * Used by systems that may run on a worker thread, where creating entities directly is not allowed.
+     * If the pool is exhausted a new laser (same components as CreateLaser) is created instead;
+     * it joins the pool when it retires.
+     */
+    static void SpawnLaser(GameWorld& world, bagel::CommandBuffer& cmd, float x, float y) {
+        bagel::ent_type laser = world.laserPool.acquire(cmd);
+        if (laser.id < 0) {
+            laser = cmd.create();
+            cmd.addAll(laser, Sprite{eSpriteID::LASER}, Collider{11.0f, 22.0f}, LaserTag{});
         }
+        cmd.addAll(laser, Position{x, y}, PrevPosition{x, y}, Velocity{0.0f, LASER_SPEED});
     }
 
     /**
@@ -486,87 +765,53 @@ namespace breakout {
      *
      * This system processes all entities that have:
      * - PowerUpType (specifying the type of power-up)
-     * - TimedEffect (duration remaining)
+     * - TimedEffect (the effect is on; TimerSystem removes it when it runs out)
      * - Position (for laser spawning)
      * - PaddleControl (indicating the entity is a paddle)
      *
      * For each matching entity:
-     * - Decreases the remaining time (`TimedEffect`) by `deltaTime`.
-     * - If time runs out:
-     *   - Removes power-up components.
-     *   - Resets paddle size if it had the WIDE_PADDLE effect.
      * - If the power-up is SHOOTING_LASER:
-     *   - Fires two lasers periodically using a cooldown timer.
+     *   - Fires two lasers periodically using a cooldown timer (taken from `laserPool` through the CommandBuffer).
      * - If the power-up is WIDE_PADDLE:
      *   - Widens the paddle (once only).
      *
-     * @param deltaTime Time (in seconds) since last frame, used for updating timers and cooldowns.
+     * @param deltaTime Time (in seconds) since last frame, used for the laser cooldown.
      *
      * Notes:
      * - Entities marked with DestroyedTag are ignored.
      * - Laser fire rate is currently hardcoded to 0.05 seconds between shots.
-     * - Paddle width is reset to 100.0f when wide power-up expires.
      */
-    void PowerUpSystem(float deltaTime) {
+    void PowerUpSystem(GameWorld& world, float deltaTime) {
         using namespace bagel;
 
-        static float laserCooldown = 0.0f;
+        World::Bind bind(world.ecs);
+        float& laserCooldown = world.laserCooldown;
+        CommandBuffer& cmd = CommandBuffer::local();
 
         // Required components: power-up info, timer, paddle position and control
-        Mask required;
-        required.set(Component<PowerUpType>::Bit);
-        required.set(Component<TimedEffect>::Bit);
-        required.set(Component<Position>::Bit);
-        required.set(Component<PaddleControl>::Bit);
-
-        for (id_type id = 0; id <= World::maxId().id; ++id) {
-            ent_type ent{id};
+        using PowerView = View<Include<PowerUpType, TimedEffect, Position, PaddleControl>, Exclude<DestroyedTag>>;
 
-            // Skip entities without required components or marked for destruction
-            if (!World::mask(ent).test(required)) continue;
-            if (World::mask(ent).test(Component<DestroyedTag>::Bit)) continue;
-
-            auto& effect = World::getComponent<TimedEffect>(ent);
-            auto& power = World::getComponent<PowerUpType>(ent);
-
-            // Update timer
-            effect.remaining -= deltaTime;
-
-            // If timer expired, remove power-up and reset properties
-            if (effect.remaining <= 0.0f) {
-                std::cout << "Power-up expired.\n";
-
-                if (power.powerUp == breakout::ePowerUpType::WIDE_PADDLE) {
-                    if (World::mask(ent).test(Component<Collider>::Bit)) {
-                        auto& col = World::getComponent<Collider>(ent);
-                        col.width = 100.0f; // Reset paddle width
-                        std::cout << "Paddle size restored.\n";
-                    }
-                }
-
-                World::delComponent<PowerUpType>(ent);
-                World::delComponent<TimedEffect>(ent);
-                continue;
-            }
+        for (ent_type ent : PowerView{}) {
+            const auto& power = World::readComponent<PowerUpType>(ent);
 
             // Laser power-up: fires two lasers every X seconds
             if (power.powerUp == ePowerUpType::SHOOTING_LASER) {
                 laserCooldown -= deltaTime;
                 if (laserCooldown <= 0.0f) {
-                    const auto& pos = World::getComponent<Position>(ent);
-                    std::cout << "Laser fired!\n";
-                    CreateLaser(pos.x + 10, pos.y);     // left
-                    CreateLaser(pos.x + 80, pos.y);     // right
+                    const auto& pos = World::readComponent<Position>(ent);
+                    BAGEL_LOG_DEBUG("Laser fired!");
+                    SpawnLaser(world, cmd, pos.x + 10, pos.y);     // left
+                    SpawnLaser(world, cmd, pos.x + 80, pos.y);     // right
                     laserCooldown = 0.05f; // adjust as needed
                 }
             }
 
             // Wide paddle effect: widen only once
             if (power.powerUp == breakout::ePowerUpType::WIDE_PADDLE) {
-                auto& col = World::getComponent<Collider>(ent);
+                const auto& col = World::readComponent<Collider>(ent);
                 if (col.width < 500.0f) {
 
-                    std::cout << "Paddle widened.\n";
+                    BAGEL_LOG_DEBUG("Paddle widened.");
                 }
             }
         }
@@ -574,106 +819,128 @@ namespace breakout {
 
     /**
      * @brief Removes all entities marked with the DestroyedTag from the game world and
-     * destroy their Box2D physics body (if they have one).
+     * destroy their Box2D physics body (if they have one). Retired bricks and power-ups
+     * are also removed from the brick lattice, and bricks are erased from `brickLayer`.
      *
      * Notes:
-     * - Components are not deleted using the ECS's built-in removal function; instead,
-     *   the mask is manually cleared bit-by-bit for safety and control.
+     * - Entities go through World::destroyEntity: their rows are swap-removed from every
+     *   PackedStorage and the id is recycled under a new generation, so handles still
+     *   held elsewhere become stale (World::isAlive returns false).
      */
-    void DestroySystem() {
-        bagel::Mask required;
-        required.set(bagel::Component<DestroyedTag>::Bit);
-
+    void DestroySystem(GameWorld& world) {
+        bagel::World::Bind bind(world.ecs);
         std::vector<bagel::ent_type> toDestroy;
 
-        for (bagel::id_type id = 0; id <= bagel::World::maxId().id; ++id) {
-            bagel::ent_type ent{id};
-            if (bagel::World::mask(ent).test(required)) {
-                toDestroy.push_back(ent);
-            }
+        for (bagel::ent_type ent : bagel::View<bagel::Include<DestroyedTag>>{}) {
+            toDestroy.push_back(ent);
         }
 
         for (auto ent : toDestroy) {
-            std::cout << "Destroying entity (manual bit clear): " << ent.id << "\n";
+            BAGEL_LOG_DEBUG("Destroying entity: {}", ent.id);
+
+            if (IsLayerBrick(bagel::World::mask(ent))) {
+                InvalidateBrick(world, ent, bagel::World::getComponent<Sprite>(ent).spriteID);
+            }
+
+            if (bagel::World::mask(ent).test(bagel::Component<LatticeTag>::Bit)) {
+                world.brickLattice.remove(ent, bagel::World::getComponent<Position>(ent));
+            }
 
             if (bagel::World::mask(ent).test(bagel::Component<PhysicsBody>::Bit)) {
                 auto& phys = bagel::World::getComponent<PhysicsBody>(ent);
                 if (b2Body_IsValid(phys.body)) {
+                    world.bodyEntities[phys.body.index1] = bagel::ent_type{-1};
                     b2DestroyBody(phys.body);
                 }
             }
 
-            // Get non-const reference to the actual mask
-            bagel::Mask& mask = bagel::World::maskMutable(ent);
-
-            int bitIndex = mask.ctz();
-            while (bitIndex >= 0) {
-                mask.clear(bagel::Mask::bit(bitIndex));
-                bitIndex = mask.ctz();
-            }
+            bagel::World::destroyEntity(ent);
         }
     }
 
     /**
-     * @brief Renders all entities that have both Position and Sprite components.
+     * @brief Collects the sprites drawn on top of `brickLayer` into a batch.
      *
      * For paddles with PowerUpType::WIDE_PADDLE, the sprite is visually scaled wider and centered.
      * Other sprites are drawn normally, with fixed scaling (0.7 or 0.4 for ball).
-     *
-     * @param ren The SDL renderer
-     * @param tex The texture containing all sprite graphics
+     * Entities with a PrevPosition are drawn between their previous and current tick position.
      */
-    void RenderSystem(SDL_Renderer* ren, SDL_Texture* tex) {
+    void PrepareSprites(GameWorld& world, SpriteBatch& batch, SDL_Texture* tex, float alpha) {
         using namespace bagel;
+        World::Bind bind(world.ecs);
 
-        Mask required;
-        required.set(Component<Position>::Bit);
-        required.set(Component<Sprite>::Bit);
-
-        for (id_type id = 0; id <= World::maxId().id; ++id) {
-            ent_type ent{id};
-            if (!World::mask(ent).test(required)) continue;
+        const SpriteFrame* frames = GetSpriteFrames(tex);
 
-            const auto& pos = World::getComponent<Position>(ent);
-            const auto& sprite = World::getComponent<Sprite>(ent);
+        batch.clear();
+        for (ent_type ent : View<Include<Position, Sprite>>{}) {
+            const Mask& mask = World::mask(ent);
+            if (IsLayerBrick(mask)) continue;
 
-            auto it = SPRITE_ATLAS.find(sprite.spriteID);
-            if (it == SPRITE_ATLAS.end()) continue;
+            const auto& pos = World::readComponent<Position>(ent);
+            const auto& sprite = World::readComponent<Sprite>(ent);
 
-            const SDL_FRect& src = it->second;
-            float scale = 0.7f;
-            float scaledW = src.w * scale;
-            float scaledH = src.h * scale;
-            float drawX = pos.x;
-            float drawY = pos.y;
+            int id = static_cast<int>(sprite.spriteID);
+            if (id < 0 || id >= SPRITE_COUNT) continue;
+            const SpriteFrame& frame = frames[id];
 
-            // Special scaling for the ball
-            if (sprite.spriteID == eSpriteID::BALL) {
-                scale = 0.4f;
-                scaledW = src.w * scale;
-                scaledH = src.h * scale;
+            SDL_FRect dst = {pos.x, pos.y, frame.w, frame.h};
+            if (mask.test(Component<PrevPosition>::Bit)) {
+                const auto& prev = World::readComponent<PrevPosition>(ent);
+                dst.x = prev.x + (pos.x - prev.x) * alpha;
+                dst.y = prev.y + (pos.y - prev.y) * alpha;
             }
 
             // Special scaling for wide paddle (visual only)
-            if (World::mask(ent).test(Component<PaddleControl>::Bit)) {
-                if (World::mask(ent).test(Component<PowerUpType>::Bit)) {
-                    const auto& power = World::getComponent<PowerUpType>(ent);
-                    if (power.powerUp == breakout::ePowerUpType::WIDE_PADDLE) {
-                        scale = 1.5f; // or 2.0f depending how wide you want
-                        scaledW = src.w * scale;
-                        scaledH = src.h * 0.7f;
-
-                        // Center the paddle visually
-                        drawX = pos.x - (scaledW - src.w * 0.7f) / 2.0f;
-                    }
+            if (mask.test(Component<PaddleControl>::Bit) && mask.test(Component<PowerUpType>::Bit)) {
+                const auto& power = World::readComponent<PowerUpType>(ent);
+                if (power.powerUp == breakout::ePowerUpType::WIDE_PADDLE) {
+                    dst.w = SPRITE_ATLAS[id].w * 1.5f; // or 2.0f depending how wide you want
+
+                    // Center the paddle visually
+                    dst.x -= (dst.w - frame.w) / 2.0f;
                 }
             }
 
-            SDL_FRect dst = {drawX, drawY, scaledW, scaledH};
-            SDL_RenderTexture(ren, tex, &src, &dst);
+            batch.add(dst, frame.uv);
         }
     }
 
+    /**
+     * @brief Renders all entities that have both Position and Sprite components.
+     *
+     * The bricks of the brick grid live in `brickLayer`, a cached render target that is only
+     * redrawn where a brick changed sprite or was destroyed (see InvalidateBrick), and is drawn
+     * with one call. All other sprites are collected into a SpriteBatch (see PrepareSprites) and
+     * submitted with a single SDL_RenderGeometry call on top of it, whatever the number of entities.
+     *
+     * @param ren The SDL renderer
+     * @param tex The texture containing all sprite graphics
+     * @param alpha Interpolation factor between PrevPosition (0) and Position (1)
+     */
+    void RenderSystem(GameWorld& world, SDL_Renderer* ren, SDL_Texture* tex, float alpha) {
+        using namespace bagel;
+        World::Bind bind(world.ecs);
+
+        static SpriteBatch batch;
+        static std::vector<ent_type> bricks;
+        const SpriteFrame* frames = GetSpriteFrames(tex);
+
+        // Static layer: redraw the invalidated areas from the bricks the lattice finds there
+        world.brickLayer.update(ren, tex, [&world, frames](const SDL_FRect& region, SpriteBatch& layerBatch) {
+            world.brickLattice.queryAABB({region.x, region.y, region.x + region.w, region.y + region.h}, bricks);
+            for (ent_type ent : bricks) {
+                if (!IsLayerBrick(World::mask(ent))) continue;
+                const auto& pos = World::readComponent<Position>(ent);
+                const SpriteFrame& frame = frames[static_cast<int>(World::getComponent<Sprite>(ent).spriteID)];
+                layerBatch.add({pos.x, pos.y, frame.w, frame.h}, frame.uv);
+            }
+        });
+        world.brickLayer.draw(ren);
+
+        PrepareSprites(world, batch, tex, alpha);
+        batch.draw(ren, tex);
+    }
+
 
     //----------------------------------
     /// @section Entity Creation Functions
@@ -691,35 +958,18 @@ namespace breakout {
      *
      * @return Unique ID of the created ball entity.
      */
-    id_type CreateBall() {
+    id_type CreateBall(GameWorld& world) {
+        bagel::World::Bind bind(world.ecs);
         bagel::Entity e = bagel::Entity::create();
 
         Position pos{400.0f, 450.0f};
         Sprite sprite{eSpriteID::BALL};
         Collider collider{87.0f * 0.4f, 77.0f * 0.4f};
 
-                // Box2D body setup
-        b2BodyDef bodyDef = b2DefaultBodyDef();
-        bodyDef.type = b2_dynamicBody;
-        bodyDef.fixedRotation = true;
-        bodyDef.position = {pos.x / 10.0f, pos.y / 10.0f};  // divide by scale
-        b2BodyId body = b2CreateBody(boxWorld, &bodyDef);
+        // Box2D body setup (divide by scale)
+        b2BodyId body = CreateBallBody(world, e.entity(), collider, {pos.x / 10.0f, pos.y / 10.0f}, {7.0f, -10.0f});
 
-
-        b2ShapeDef ballShapeDef = b2DefaultShapeDef();
-        ballShapeDef.enableSensorEvents = true;
-        ballShapeDef.density = 1;
-        ballShapeDef.material.friction = 0;
-        ballShapeDef.material.restitution = 1.0f; // the ball became too quick
-
-        b2Circle circle = {0, 0, (87.0f * 0.4f / 2.0f) / 10.0f}; // radius in meters
-        b2CreateCircleShape(body, &ballShapeDef, &circle);
-
-        b2Vec2 velocity = {7.0f, -10.0f};
-        b2Body_SetLinearVelocity(body, velocity);
-        b2Body_SetUserData(body, new bagel::ent_type{e.entity()});
-
-        e.addAll(pos, sprite, collider, BallTag{}, PhysicsBody{body}
+        e.addAll(pos, PrevPosition{pos.x, pos.y}, sprite, collider, BallTag{}, PhysicsBody{body}
         );
 
         return e.entity().id;
@@ -727,13 +977,17 @@ namespace breakout {
 
     /**
      * @brief Creates a new brick entity with position, brickHealth sprite, and collision.
+     * Its static Box2D body bounces the ball and reports the contact.
      *
      * @return Unique entity ID
      */
-    id_type CreateBrick(int health, eSpriteID color, float x, float y) {
+    id_type CreateBrick(GameWorld& world, int health, eSpriteID color, float x, float y) {
+        bagel::World::Bind bind(world.ecs);
         bagel::Entity e = bagel::Entity::create();
+        Position pos{x, y};
         Collider collider{171.0f * 0.7f, 59.0f * 0.7f};
-        e.addAll(Position{x,y}, Sprite{color}, collider, BrickHealth{health});
+        b2BodyId body = CreateBoxBody(world, e.entity(), b2_staticBody, pos, collider);
+        e.addAll(pos, PrevPosition{x,y}, Sprite{color}, collider, BrickHealth{health}, PhysicsBody{body});
         return e.entity().id;
     }
 
@@ -741,13 +995,15 @@ namespace breakout {
      * @brief Creates a paddle entity with position, sprite, collision, and input controls.
      *
      * The paddle is placed near the bottom of the screen with a default sprite and
-     * a collider for ball interaction. It responds to the provided keyboard keys.
+     * a collider and a kinematic Box2D body for ball interaction. It responds to the provided
+     * keyboard keys.
      *
      * @param left Key code (SDL_Scancode) for moving left
      * @param right Key code (SDL_Scancode) for moving right
      * @return Unique entity ID
      */
-     id_type CreatePaddle(int leftKey, int rightKey) {
+     id_type CreatePaddle(GameWorld& world, int leftKey, int rightKey) {
+         bagel::World::Bind bind(world.ecs);
          bagel::Entity e = bagel::Entity::create();
 
          float paddleWidth = 161.0f * 0.7f;
@@ -757,25 +1013,31 @@ namespace breakout {
          Sprite sprite{eSpriteID::PADDLE};
          Collider collider{paddleWidth, paddleHeight};
          PaddleControl control{leftKey, rightKey};
+         b2BodyId body = CreateBoxBody(world, e.entity(), b2_kinematicBody, pos, collider);
 
-         e.addAll(pos, sprite, collider, control);
+         e.addAll(pos, PrevPosition{pos.x, pos.y}, sprite, collider, control, PhysicsBody{body});
          return e.entity().id;
      }
 
     /**
      * @brief Creates a floor entity to check if ball hit the floor - game over.
+     * Its Box2D sensor reports the ball passing through.
      * @return Unique entity ID
      */
-    id_type CreateFloor() {
+    id_type CreateFloor(GameWorld& world) {
+        bagel::World::Bind bind(world.ecs);
         bagel::Entity e = bagel::Entity::create();
-        e.addAll(Position{0.0f, 590.0f}, Collider{800.0f, 10.0f}, FloorTag{});
+        Position pos{0.0f, 590.0f};
+        Collider collider{800.0f, 10.0f};
+        b2BodyId body = CreateBoxBody(world, e.entity(), b2_staticBody, pos, collider, true);
+        e.addAll(pos, collider, FloorTag{}, PhysicsBody{body});
         return e.entity().id;
     }
 
     /**
     * @brief Creates the walls - only Box2d not entities.
      */
-    void CreateWalls() {
+    void CreateWalls(GameWorld& world) {
         constexpr float screenW = 800.0f;
         constexpr float screenH = 600.0f;
         constexpr float scale = 10.0f;
@@ -788,13 +1050,13 @@ namespace breakout {
 
         // Top wall
         bodyDef.position = {screenW / 2.0f / 10.0f, -1.0f}; // y = -10px
-        b2BodyId top = b2CreateBody(boxWorld, &bodyDef);
+        b2BodyId top = b2CreateBody(world.boxWorld, &bodyDef);
         b2Polygon topBox = b2MakeBox(screenW / 2.0f / 10.0f, 1.0f);
         b2CreatePolygonShape(top, &shapeDef, &topBox);
 
         // Left wall
         bodyDef.position = {-1.0f, screenH / 2.0f / 10.0f};
-        b2BodyId left = b2CreateBody(boxWorld, &bodyDef);
+        b2BodyId left = b2CreateBody(world.boxWorld, &bodyDef);
         b2Polygon leftBox = b2MakeBox(1.0f, screenH / 2.0f / 10.0f);
         b2CreatePolygonShape(left, &shapeDef, &leftBox);
 
@@ -802,7 +1064,7 @@ namespace breakout {
         float halfWallW = 1.0f;
         float wallX = (screenW / scale) - halfWallW;
         bodyDef.position = {wallX, screenH / 2.0f / scale};
-        b2BodyId right = b2CreateBody(boxWorld, &bodyDef);
+        b2BodyId right = b2CreateBody(world.boxWorld, &bodyDef);
         b2Polygon rightBox = b2MakeBox(halfWallW, screenH / 2.0f / scale);
         b2CreatePolygonShape(right, &shapeDef, &rightBox);
     }
@@ -811,20 +1073,23 @@ namespace breakout {
      * @brief Creates a star power-up entity at the given position.
      *
      * The star grants the paddle a laser-shooting power-up when collected.
-     * It includes a position, sprite, collider, and a StarPowerTag to identify its type.
+     * It includes a position, sprite, collider, a static Box2D body, and a StarPowerTag to identify its type.
      *
      * @param x Horizontal position on the screen.
      * @param y Vertical position on the screen.
      * @return The unique ID of the created star entity.
      */
-    id_type CreateStar(float x, float y) {
+    id_type CreateStar(GameWorld& world, float x, float y) {
+        bagel::World::Bind bind(world.ecs);
         bagel::Entity e = bagel::Entity::create();
 
         Position pos{x, y};
         Sprite sprite{eSpriteID::STAR};
         Collider collider{84.0f * 0.7f, 73.0f * 0.7f};
 
-        e.addAll(pos, sprite, collider, StarPowerTag{});
+        b2BodyId body = CreateBoxBody(world, e.entity(), b2_staticBody, pos, collider);
+
+        e.addAll(pos, PrevPosition{x, y}, sprite, collider, StarPowerTag{}, PhysicsBody{body});
         return e.entity().id;
     }
 
@@ -832,79 +1097,406 @@ namespace breakout {
      * @brief Creates a heart power-up entity at the given position.
      *
      * The heart grants the paddle a wide-paddle power-up when collected.
-     * It includes a position, sprite, collider, and a HeartPowerTag to identify its type.
+     * It includes a position, sprite, collider, a static Box2D body, and a HeartPowerTag to identify its type.
      *
      * @param x Horizontal position on the screen.
      * @param y Vertical position on the screen.
      * @return The unique ID of the created heart entity.
      */
-    id_type CreateHeart(float x, float y) {
+    id_type CreateHeart(GameWorld& world, float x, float y) {
+        bagel::World::Bind bind(world.ecs);
         bagel::Entity e = bagel::Entity::create();
 
         Position pos{x, y};
         Sprite sprite{eSpriteID::HEART};
         Collider collider{84.0f * 0.7f, 73.0f * 0.7f};
 
-        e.addAll(pos, sprite, collider, HeartPowerTag{});
+        b2BodyId body = CreateBoxBody(world, e.entity(), b2_staticBody, pos, collider);
+
+        e.addAll(pos, PrevPosition{x, y}, sprite, collider, HeartPowerTag{}, PhysicsBody{body});
         return e.entity().id;
     }
 
+    /** @brief Creates a laser entity in the World bound to the calling thread (see CreateLaser). */
+    static bagel::ent_type BuildLaser(float x, float y) {
+        bagel::Entity e = bagel::Entity::create();
+
+        Position pos{x, y};
+        Velocity vel{0.0f, LASER_SPEED};
+        Sprite sprite{eSpriteID::LASER};
+        Collider collider{11.0f, 22.0f}; // exact sprite size
+        LaserTag tag;
+
+        e.addAll(pos, PrevPosition{x, y}, vel, sprite, collider, tag);
+        return e.entity();
+    }
+
+    /** @brief Builds a laser for `GameWorld::laserPool`, parked above the screen. */
+    static bagel::ent_type BuildLaser() {
+        return BuildLaser(0.0f, -100.0f);
+    }
+
     /**
      * @brief Creates a laser entity that moves upward and destroys bricks on contact.
      *
-     * The laser moves slowly (dy = -100) to visually match a "weaker" power-up effect.
+     * The laser moves upward at LASER_SPEED (pixels per second).
      *
      * @param x Horizontal position where the laser is spawned.
      * @param y Vertical position where the laser is spawned.
      * @return The unique ID of the created laser entity.
      */
-    id_type CreateLaser(float x, float y) {
-        bagel::Entity e = bagel::Entity::create();
-
-        Position pos{x, y};
-        Velocity vel{0.0f, -200.0f}; // slower upward movement
-        Sprite sprite{eSpriteID::LASER};
-        Collider collider{11.0f, 22.0f}; // exact sprite size
-        LaserTag tag;
-
-        e.addAll(pos, vel, sprite, collider, tag);
-        return e.entity().id;
+    id_type CreateLaser(GameWorld& world, float x, float y) {
+        bagel::World::Bind bind(world.ecs);
+        return BuildLaser(x, y).id;
     }
 
     //----------------------------------
     /// @section Game Loop
     //----------------------------------
 
+    /** @brief FNV-1a over raw bytes, continuing from `hash`. */
+    static std::uint64_t HashBytes(std::uint64_t hash, const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /** @brief Hashes component T of `e` if it has one. */
+    template <class T>
+    static std::uint64_t HashComponent(std::uint64_t hash, bagel::ent_type e) {
+        if (!bagel::World::mask(e).test(bagel::Component<T>::Bit)) return hash;
+        const T& value = bagel::World::readComponent<T>(e);
+        return HashBytes(hash, &value, sizeof(T));
+    }
+
+    /**
+     * @brief Hash of the simulation state (see breakout_game.h).
+     *
+     * Components are hashed as raw bytes: they are plain structs of floats and ints without
+     * padding (but TimedEffect, hashed field by field). Walks every id up to maxId; only used
+     * when recording, verifying or rewinding a replay.
+     */
+    std::uint64_t WorldChecksum(GameWorld& world, bool bodies) {
+        using namespace bagel;
+        World::Bind bind(world.ecs);
+
+        std::uint64_t hash = 14695981039346656037ull;
+        const id_type maxId = World::maxId().id;
+        hash = HashBytes(hash, &maxId, sizeof(maxId));
+
+        for (id_type id = 0; id <= maxId; ++id) {
+            const ent_type e = World::handle(id);
+            const bool active = World::isActive(e);
+            hash = HashBytes(hash, &e, sizeof(e));
+            hash = HashBytes(hash, &World::mask(e), sizeof(Mask));
+            hash = HashBytes(hash, &active, sizeof(active));
+
+            hash = HashComponent<Position>(hash, e);
+            hash = HashComponent<Velocity>(hash, e);
+            hash = HashComponent<Collider>(hash, e);
+            hash = HashComponent<BrickHealth>(hash, e);
+            hash = HashComponent<Sprite>(hash, e);
+            hash = HashComponent<PowerUpType>(hash, e);
+            hash = HashComponent<BreakAnimation>(hash, e);
+
+            if (World::mask(e).test(Component<TimedEffect>::Bit)) {
+                const TimedEffect& effect = World::readComponent<TimedEffect>(e);
+                hash = HashBytes(hash, &effect.duration, sizeof(effect.duration));
+                hash = HashBytes(hash, &effect.timer, sizeof(effect.timer));
+            }
+            if (bodies && World::mask(e).test(Component<PhysicsBody>::Bit)) {
+                const b2BodyId body = World::readComponent<PhysicsBody>(e).body;
+                if (b2Body_IsValid(body)) {
+                    const b2Vec2 p = b2Body_GetPosition(body);
+                    const b2Vec2 v = b2Body_GetLinearVelocity(body);
+                    hash = HashBytes(hash, &p, sizeof(p));
+                    hash = HashBytes(hash, &v, sizeof(v));
+                }
+            }
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Creates the Box2D world and the level: walls, paddle, ball, floor, the brick grid
+     * and the warm lasers of `laserPool`.
+     *
+     * @param world The match.
+     * @param tasks Task callbacks of the world (see PrepareBoxWorld).
+     * @param rows Rows of the brick grid.
+     * @param cols Columns of the brick grid.
+     * @return false if no Box2D world could be created.
+     */
+    bool CreateLevel(GameWorld& world, PhysicsTasks& tasks, int rows, int cols) {
+        bagel::World::Bind bind(world.ecs);
+        if (!PrepareBoxWorld(world, tasks)) return false;
+        CreateWalls(world);
+        CreatePaddle(world, SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT);
+        CreateBall(world);
+        CreateFloor(world);
+        CreateBrickGrid(world, rows, cols, 1); // health = 1
+        world.laserPool.reserve(16);           // more lasers than fit on screen at the fire rate
+        return true;
+    }
+
+    /** @brief Box2D state of an entity's body that its components do not hold, saved in level snapshots. */
+    struct BodyState {
+        bagel::ent_type e{-1};
+        b2Vec2 position{};  ///< Body origin (meters)
+        b2Vec2 velocity{};  ///< Linear velocity (meters per second)
+        bool enabled = true;
+    };
+
+    /** @brief Tags of the level snapshot's own blocks (after the World's, see bagel::Snapshot). */
+    enum eLevelBlock {
+        LATTICE_BLOCK = 0, ///< BrickLattice::Geometry of `brickLattice`
+        BODY_BLOCK = 1,    ///< One BodyState per entity with a PhysicsBody, by increasing id
+    };
+
+    /** @brief Records the level blocks of a snapshot (a layout only when the arrays are empty). */
+    static void PutLevelBlocks(bagel::SnapshotBlocks& blocks, const BrickLattice::Geometry* geometry,
+                               const std::vector<BodyState>& bodies) {
+        blocks.begin(LATTICE_BLOCK);
+        blocks.put(geometry, geometry != nullptr ? 1 : 0);
+        blocks.begin(BODY_BLOCK);
+        blocks.put(bodies.data(), static_cast<bagel::size_type>(bodies.size()));
+    }
+
+    /**
+     * @brief Saves the level (see breakout_game.h): the World through bagel::Snapshot, plus the
+     * lattice geometry and the Box2D state of every body.
+     */
+    bool SaveLevel(GameWorld& world, const char* path) {
+        using namespace bagel;
+        World::Bind bind(world.ecs);
+
+        std::vector<BodyState> bodies;
+        const id_type maxId = World::maxId().id;
+        for (id_type id = 0; id <= maxId; ++id) {
+            const ent_type e = World::handle(id);
+            if (!World::mask(e).test(Component<PhysicsBody>::Bit)) continue;
+            const b2BodyId body = World::readComponent<PhysicsBody>(e).body;
+            if (!b2Body_IsValid(body)) continue;
+            bodies.push_back({e, b2Body_GetPosition(body), b2Body_GetLinearVelocity(body), b2Body_IsEnabled(body)});
+        }
+
+        const BrickLattice::Geometry geometry = world.brickLattice.geometry();
+        SnapshotBlocks level;
+        PutLevelBlocks(level, &geometry, bodies);
+        return Snapshot::save(path, &level);
+    }
+
+    /**
+     * @brief Loads a level saved by SaveLevel (see breakout_game.h).
+     *
+     * The World adopts the snapshot's arrays in place; what lives outside it is then rebuilt in
+     * one pass each: the Box2D bodies (from the saved BodyState list, with the same shapes as the
+     * Create functions), the brick lattice, the brick layer, `laserPool` (the inactive lasers)
+     * and the timers of running break animations and power-ups, which restart in full.
+     *
+     * The level blocks are checked against the loaded World first (one lattice geometry, every
+     * body's entity alive and holding Position, Collider and PhysicsBody); if they disagree,
+     * false is returned before the Box2D world or anything outside the World is touched.
+     */
+    bool LoadLevel(GameWorld& world, const char* path, PhysicsTasks& tasks) {
+        using namespace bagel;
+        World::Bind bind(world.ecs);
+
+        SnapshotBlocks layout;
+        PutLevelBlocks(layout, nullptr, {});
+        if (!Snapshot::load(path, &layout)) return false;
+
+        SnapshotBlocks& level = Snapshot::app();
+        size_type geometries = 0, count = 0;
+        level.begin(LATTICE_BLOCK);
+        const BrickLattice::Geometry* geometry = level.take<BrickLattice::Geometry>(geometries);
+        level.begin(BODY_BLOCK);
+        const BodyState* bodies = level.take<BodyState>(count);
+
+        // Check the level blocks against the loaded World before anything else is rebuilt
+        if (geometries != 1 || geometry->rows < 0 || geometry->cols < 0 ||
+            static_cast<std::int64_t>(geometry->rows) * geometry->cols > World::maxId().id + 1) {
+            return false;
+        }
+        const Mask needed = MaskBuilder().set<Position>().set<Collider>().set<PhysicsBody>().build();
+        for (size_type i = 0; i < count; ++i) {
+            const ent_type e = bodies[i].e;
+            if (e.id < 0 || e.id > World::maxId().id || !World::isAlive(e) || !World::mask(e).test(needed)) return false;
+        }
+
+        // Box2D bodies, the walls included
+        if (!PrepareBoxWorld(world, tasks)) return false;
+        CreateWalls(world);
+        for (size_type i = 0; i < count; ++i) {
+            const BodyState& state = bodies[i];
+            const Mask& mask = World::mask(state.e);
+            const Collider& col = World::getComponent<Collider>(state.e);
+            b2BodyId body;
+            if (mask.test(Component<BallTag>::Bit)) {
+                body = CreateBallBody(world, state.e, col, state.position, state.velocity);
+            }
+            else {
+                const b2BodyType type = mask.test(Component<PaddleControl>::Bit) ? b2_kinematicBody : b2_staticBody;
+                body = CreateBoxBody(world, state.e, type, World::getComponent<Position>(state.e), col,
+                                     mask.test(Component<FloorTag>::Bit));
+            }
+            if (!state.enabled) b2Body_Disable(body);
+            World::getComponent<PhysicsBody>(state.e).body = body;
+        }
+
+        world.brickLattice.configure(geometry->originX, geometry->originY, geometry->pitchX, geometry->pitchY,
+                                     geometry->rows, geometry->cols);
+        for (ent_type e : View<Include<LatticeTag, Position, Collider>>{}) {
+            const Position& pos = World::getComponent<Position>(e);
+            world.brickLattice.place(e, pos, MakeAABB(pos, World::getComponent<Collider>(e)));
+        }
+        world.brickLayer.invalidateAll();
+
+        world.laserPool.clear();
+        world.timers.clear();
+        const id_type maxId = World::maxId().id;
+        for (id_type id = 0; id <= maxId; ++id) {
+            const ent_type e = World::handle(id);
+            const Mask& mask = World::mask(e);
+            if (mask.test(Component<LaserTag>::Bit) && !World::isActive(e)) world.laserPool.adopt(e);
+            if (mask.test(Component<BreakAnimation>::Bit)) {
+                StartTimer(world, e, eTimer::BREAK_ANIMATION,
+                           BREAK_ANIMATION_END - World::getComponent<BreakAnimation>(e).timer);
+            }
+            if (mask.test(Component<TimedEffect>::Bit)) {
+                auto& effect = World::getComponent<TimedEffect>(e);
+                effect.timer = StartTimer(world, e, eTimer::TIMED_EFFECT, effect.duration);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Registers the systems of one simulation tick in a scheduler, in tick order.
+     *
+     * Each system is declared with the components (and resources) it reads and writes, so
+     * systems that do not conflict run concurrently on the scheduler's JobSystem.
+     *
+     * @param world The match the systems run on (the scheduler's World must be `world.ecs`).
+     * @param systems Scheduler to fill.
+     * @param keys Key states read by PlayerControlSystem; the caller updates the pointer before every tick.
+     * @param deltaTime Fixed simulation time step (seconds).
+     */
+    static void AddSystems(GameWorld& world, bagel::Scheduler& systems, const bool* const& keys, float deltaTime) {
+        using namespace bagel;
+
+        world.timerTick = deltaTime;
+
+        systems.add(System<Reads<Position>, Writes<PrevPosition>>{}, [&world] {
+            BAGEL_ZONE("PrevPositionSystem");
+            PrevPositionSystem(world);                     // Keep last tick's positions for interpolation
+        });
+        systems.addMain(System<Reads<PaddleControl, Collider, PhysicsBody>, Writes<Position, PhysicsWorld>>{},
+                        [&world, &keys, deltaTime] {
+            BAGEL_ZONE("PlayerControlSystem");
+            PlayerControlSystem(world, keys, deltaTime);   // Move paddle based on user input
+        });
+        systems.add(System<Reads<Velocity, Collider, LaserTag, DestroyedTag>, Writes<Position, LaserPool>>{},
+                    [&world, deltaTime] {
+            BAGEL_ZONE("MovementSystem");
+            MovementSystem(world, deltaTime);              // Move entities with velocity
+        });
+        systems.add(System<Reads<PhysicsBody>, Writes<Position, PhysicsWorld>>{}, [&world, deltaTime] {
+            BAGEL_ZONE("PhysicsSystem");
+            PhysicsSystem(world, deltaTime);               // Handle physics world movement
+        });
+        systems.add(System<Reads<Position, Collider, PaddleControl, BallTag, LaserTag, FloorTag, StarPowerTag,
+                                 HeartPowerTag, BreakAnimation, DestroyedTag, BrickLattice, PhysicsBody>,
+                           Writes<BrickHealth, Sprite, PhysicsWorld, StaticLayer, TimerWheel>>{}, [&world] {
+            BAGEL_ZONE("CollisionSystem");
+            CollisionSystem(world);                        // Handle the contacts of the step (ball-brick, laser-brick, ball-star)
+        });
+        systems.add(System<Reads<DestroyedTag, TimedEffect, PowerUpType>, Writes<Collider, TimerWheel>>{}, [&world] {
+            BAGEL_ZONE("TimerSystem");
+            TimerSystem(world);                            // End break animations and expired power-ups
+        });
+        systems.add(System<Reads<PowerUpType, TimedEffect, Position, PaddleControl, DestroyedTag, Collider>,
+                           Writes<LaserPool>>{}, [&world, deltaTime] {
+            BAGEL_ZONE("PowerUpSystem");
+            PowerUpSystem(world, deltaTime);               // Handle laser timer and shooting
+        });
+    }
+
+    /**
+     * @brief Runs one simulation tick: the scheduled systems, then the queued structural changes
+     * and DestroySystem.
+     */
+    static void Tick(GameWorld& world, bagel::Scheduler& systems) {
+        BAGEL_ZONE("Tick");
+        systems.run();
+
+        {
+            BAGEL_ZONE("World::step");
+            bagel::World::Bind bind(world.ecs);
+            bagel::World::step();               // Apply queued component changes
+        }
+        BAGEL_ZONE("DestroySystem");
+        DestroySystem(world);                   // Remove entities with DestroyedTag
+    }
+
     /**
      * @brief Main game loop for the Breakout ECS-style game.
      *
      * Initializes all core entities (paddle, ball, bricks),
      * and continuously runs input handling, system updates, and rendering each frame.
-     * This loop uses deltaTime (elapsed time per frame) to update all time-based systems.
+     *
+     * The simulation advances in fixed ticks of 1 / tickRate seconds: the real time elapsed
+     * between frames is added to an accumulator and as many ticks as it holds are run (at most
+     * MAX_TICKS_PER_FRAME; after a longer stall the remaining time is dropped, so the game slows
+     * down instead of falling further behind). Rendering then interpolates every entity between
+     * its previous and current tick position by the time left in the accumulator.
+     *
+     * The tick systems are registered once in a bagel::Scheduler (see AddSystems).
+     *
+     * When built with BAGEL_PROFILE, every system runs inside a BAGEL_ZONE; per-zone
+     * percentiles are printed on exit and the zones are written to breakout_trace.json.
      *
      * @param ren SDL renderer used for drawing game objects.
      * @param tex SDL texture sheet containing all game sprites.
+     * @param tickRate Simulation ticks per second.
+     * @param maxFps Upper bound on rendered frames per second.
      */
-    void run(SDL_Renderer* ren, SDL_Texture* tex) {
+    void run(SDL_Renderer* ren, SDL_Texture* tex, float tickRate, float maxFps, InputLog* record) {
         using namespace bagel;
 
+        constexpr int MAX_TICKS_PER_FRAME = 8;
+        const Uint64 tickNS = static_cast<Uint64>(1e9 / tickRate);
+        const Uint64 minFrameNS = static_cast<Uint64>(1e9 / maxFps);
+
         // === Initialization ===
-        PrepareBoxWorld();
-        CreateWalls();
-        CreatePaddle(SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT);
-        CreateBall();
-        CreateFloor();
-        CreateBrickGrid(4, 6, 1); // 4 rows × 6 cols, health = 1
+        GameWorld world;
+        JobSystem jobs;
+        PhysicsTasks physicsTasks(jobs);
+        if (!CreateLevel(world, physicsTasks, 4, 6)) {
+            std::cerr << "Failed to create the Box2D world\n";
+            return;
+        }
 
         // Timer and control flag for delayed star spawning
         float elapsedTime = 0.0f;
         bool starSpawned = false;
+        const bool* keys = nullptr;
+
+        // === Systems, in tick order ===
+        Scheduler systems(jobs, world.ecs);
+        AddSystems(world, systems, keys, 1.0f / tickRate);
 
         bool quit = false;
         SDL_Event e;
+        Uint64 accumulator = 0;
+        Uint64 previous = SDL_GetTicksNS();
 
         while (!quit) {
-            Uint32 frameStart = SDL_GetTicks();
+            Uint64 frameStart = SDL_GetTicksNS();
+            accumulator = std::min(accumulator + (frameStart - previous), MAX_TICKS_PER_FRAME * tickNS);
+            previous = frameStart;
 
             // === Input handling ===
             SDL_PumpEvents();
@@ -913,34 +1505,102 @@ namespace breakout {
                     (e.type == SDL_EVENT_KEY_DOWN && e.key.scancode == SDL_SCANCODE_ESCAPE)) {
                     quit = true;
                 }
+                // The brick layer's target texture lost its contents, or no longer exists or fits
+                else if (e.type == SDL_EVENT_RENDER_TARGETS_RESET) {
+                    world.brickLayer.invalidateAll();
+                }
+                else if (e.type == SDL_EVENT_RENDER_DEVICE_RESET || e.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED) {
+                    world.brickLayer.release();
+                }
+            }
+            keys = SDL_GetKeyboardState(nullptr);
+
+            // === Game logic (fixed ticks) ===
+            while (accumulator >= tickNS) {
+                Tick(world, systems);
+                if (record) record->record(keys, WorldChecksum(world));
+                accumulator -= tickNS;
+                elapsedTime += 1.0f / tickRate;
             }
 
-            // === Game logic systems ===
-            PlayerControlSystem();     // Move paddle based on user input
-            MovementSystem();          // Move entities with velocity
-            CollisionSystem();         // Handle collisions (ball-brick, laser-brick, ball-star)
+            // === Rendering ===
+            {
+                BAGEL_ZONE("RenderSystem");
+                SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
+                SDL_RenderClear(ren);
+                RenderSystem(world, ren, tex, static_cast<float>(accumulator) / tickNS);
+            }
+            {
+                BAGEL_ZONE("SDL_RenderPresent");
+                SDL_RenderPresent(ren);
+            }
 
-            // deltaTime will be passed in later
-            World::step();             // Apply queued component changes
+            // === Frame limiting ===
+            Uint64 frameTime = SDL_GetTicksNS() - frameStart;
+            if (frameTime < minFrameNS) SDL_DelayNS(minFrameNS - frameTime);
+        }
 
-            // === Rendering ===
-            SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
-            SDL_RenderClear(ren);
-            RenderSystem(ren, tex);
-            SDL_RenderPresent(ren);
+        world.brickLayer.release();
+
+        BAGEL_LOG_FLUSH();
+        BAGEL_PROFILE_REPORT(std::cout);
+        BAGEL_PROFILE_DUMP("breakout_trace.json");
+    }
+
+    /**
+     * @brief Runs the simulation without SDL: no window, no rendering, no keyboard.
+     *
+     * Every tick runs the same systems as run(), with a fixed deltaTime of 1 / tickRate.
+     * Input comes from the script instead of SDL_GetKeyboardState. Nothing is shared with other
+     * GameWorlds but Box2D's world table, so independent matches can run on several threads.
+     *
+     * @param world The match, bound to the calling thread for the whole run.
+     * @param ticks Number of ticks to simulate.
+     * @param tickRate Simulated ticks per second.
+     * @param paced If true, ticks are spaced 1 / tickRate apart in wall-clock time;
+     *              otherwise the simulation runs as fast as the CPU allows.
+     * @param input Called before every tick to fill the key states (cleared first).
+     * @param workers Threads running the systems and the physics solver, the caller included;
+     *                0 for one per hardware thread.
+     * @param observer Called after every tick, e.g. to record or verify WorldChecksum().
+     * @param level Level snapshot to start from (see LoadLevel); null for the default level.
+     * @return Wall-clock seconds spent simulating, or -1 if the level could not be created or loaded.
+     */
+    double runHeadless(GameWorld& world, int ticks, float tickRate, bool paced, const InputScript& input,
+                       int workers, const TickObserver& observer, const char* level) {
+        using namespace bagel;
+        using Clock = std::chrono::steady_clock;
 
-            // === Frame limiting (target ~60 FPS) ===
-            Uint32 frameTime = SDL_GetTicks() - frameStart;
-            if (frameTime < 16) SDL_Delay(16 - frameTime);
+        World::Bind bind(world.ecs);
+        JobSystem jobs(workers > 0 ? workers - 1 : JobSystem::defaultThreads());
+        PhysicsTasks physicsTasks(jobs);
+        if (level == nullptr ? !CreateLevel(world, physicsTasks, 4, 6) : !LoadLevel(world, level, physicsTasks)) {
+            return -1.0;
+        }
 
-            // === Time-based systems ===
-            float deltaTime = frameTime / 1000.0f;
-            elapsedTime += deltaTime;
+        bool keyState[SDL_SCANCODE_COUNT];
+        const bool* keys = keyState;
 
-            BreakAnimationSystem(deltaTime); // Animate broken bricks
-            PowerUpSystem(deltaTime);        // Handle laser timer and shooting
-            PhysicsSystem(deltaTime);        // Handle physics world movement
-            DestroySystem();                 // Remove entities with DestroyedTag
+        Scheduler systems(jobs, world.ecs);
+        AddSystems(world, systems, keys, 1.0f / tickRate);
+
+        const auto tickLength = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / tickRate));
+        const Clock::time_point start = Clock::now();
+
+        for (int tick = 0; tick < ticks; ++tick) {
+            std::fill(std::begin(keyState), std::end(keyState), false);
+            if (input) input(tick, keyState);
+
+            Tick(world, systems);
+            if (observer) observer(tick, keyState);
+
+            if (paced) std::this_thread::sleep_until(start + tickLength * (tick + 1));
         }
+
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        BAGEL_LOG_FLUSH();
+        BAGEL_PROFILE_REPORT(std::cout);
+        BAGEL_PROFILE_DUMP("breakout_trace.json");
+        return seconds;
     }
 } //namespace breakout;
\ No newline at end of file
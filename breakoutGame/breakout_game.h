@@ -11,12 +11,18 @@
 #include <cstdint>
 #include "SDL3_image/SDL_image.h"
 #include <box2d/box2d.h>
+#include <functional>
 #include <unordered_map>
 
 namespace breakout {
 
     using id_type = int;
 
+    struct GameWorld;
+    class InputLog;
+    class PhysicsTasks;
+    class SpriteBatch;
+
     /** @brief Enum representing all possible sprite types in the game. */
     enum class eSpriteID {
         BALL = 0,
@@ -51,10 +57,16 @@ namespace breakout {
         float y = 0.0f; ///< Vertical position
     };
 
+    /** @brief Position at the previous simulation tick, used to interpolate rendering between ticks. */
+    struct PrevPosition {
+        float x = 0.0f;
+        float y = 0.0f;
+    };
+
     /** @brief Velocity vector defining movement direction and speed. */
     struct Velocity {
-        float dx = 0.0f; ///< Horizontal speed
-        float dy = 0.0f; ///< Vertical speed
+        float dx = 0.0f; ///< Horizontal speed (pixels per second)
+        float dy = 0.0f; ///< Vertical speed (pixels per second)
     };
 
     /** @brief Graphical representation of the entity. Uses sprite ID from eSpriteID enum. */
@@ -89,7 +101,8 @@ namespace breakout {
 
     /** @brief Temporary effect applied to the entity, with duration. */
     struct TimedEffect {
-        float remaining = 0.0f; ///< Remaining time for power-up
+        float duration = 0.0f;   ///< Duration of the power-up (in seconds)
+        std::uint64_t timer = 0; ///< bagel::TimerWheel id of the timer that ends the effect
     };
 
     /** @brief Marks an entity to be removed from the game. */
@@ -100,7 +113,7 @@ namespace breakout {
 
     /** @brief Component used to animate a brick before it's destroyed. */
     struct BreakAnimation {
-        float timer = 0.0f; ///< Countdown before removal (in seconds)
+        float timer = 0.0f; ///< Animation time already elapsed when it starts (in seconds)
     };
 
     /** @brief Tag for star power-up. */
@@ -112,6 +125,9 @@ namespace breakout {
     /** @brief Tag to identify laser entities. */
     struct LaserTag {};
 
+    /** @brief Tag for entities indexed by the brick lattice (bricks, star, heart of the brick grid). */
+    struct LatticeTag {};
+
     /** @brief Component used to save the information of the box2d. */
     struct PhysicsBody {
         b2BodyId body;
@@ -121,75 +137,129 @@ namespace breakout {
     /// @section Systems (declarations only)
     //----------------------------------
 
-    /** @brief Updates entity positions based on velocity components. */
-    void MovementSystem();
+    /** @brief Copies Position to PrevPosition at the start of a simulation tick. */
+    void PrevPositionSystem(GameWorld& world);
+
+    /**
+     * @brief Updates entity positions based on velocity components.
+     *
+     * @param world The match (see game_world.h).
+     * @param deltaTime Simulation time step (seconds).
+     */
+    void MovementSystem(GameWorld& world, float deltaTime);
+
+    /**
+     * @brief Steps the Box2D world and copies the positions of the bodies it moved.
+     *
+     * @param world The match (see game_world.h).
+     * @param deltaTime Simulation time step (seconds).
+     */
+    void PhysicsSystem(GameWorld& world, float deltaTime);
 
     /** @brief Handles collisions between entities and triggers side effects. */
-    void CollisionSystem();
+    void CollisionSystem(GameWorld& world);
 
-    /** @brief Handles player input and updates paddle position accordingly. */
-    void PlayerControlSystem();
+    /**
+     * @brief Handles player input and updates paddle position accordingly.
+     *
+     * @param world The match.
+     * @param keys Key states indexed by SDL_Scancode.
+     * @param deltaTime Simulation time step (seconds).
+     */
+    void PlayerControlSystem(GameWorld& world, const bool* keys, float deltaTime);
 
     /**
-     * @brief Activates power-up logic and tracks timed effects.
+     * @brief Activates power-up logic (laser firing) while a timed effect is on.
      *
+     * @param world The match.
      * @param deltaTime Time elapsed since last frame.
      */
-    void PowerUpSystem(float deltaTime);
+    void PowerUpSystem(GameWorld& world, float deltaTime);
 
     /** @brief Removes entities marked with DestroyedTag. */
-    void DestroySystem();
+    void DestroySystem(GameWorld& world);
 
     /**
      * @brief Renders all entities that have both Position and Sprite components.
      *
+     * @param world The match to draw.
      * @param ren The SDL renderer to use.
      * @param tex The texture sheet containing all sprites.
+     * @param alpha Fraction of a simulation tick elapsed since the last tick, in [0, 1):
+     *              positions are interpolated between PrevPosition and Position.
      */
-    void RenderSystem(SDL_Renderer* ren, SDL_Texture* tex);
+    void RenderSystem(GameWorld& world, SDL_Renderer* ren, SDL_Texture* tex, float alpha = 1.0f);
 
     /**
-     * @brief Handles the animation of bricks breaking over time.
+     * @brief Fills a batch with the sprites RenderSystem draws on top of the cached brick layer
+     *        (everything but the bricks of the brick grid). Makes no SDL call but reading the
+     *        size of `tex`.
      *
-     * @param deltaTime Time elapsed since last frame.
+     * @param world The match to draw.
+     * @param batch Cleared, then filled with one quad per sprite.
+     * @param tex The texture sheet the quads' coordinates refer to.
+     * @param alpha Interpolation factor between PrevPosition (0) and Position (1).
      */
-    void BreakAnimationSystem(float deltaTime);
+    void PrepareSprites(GameWorld& world, SpriteBatch& batch, SDL_Texture* tex, float alpha);
+
+    /**
+     * @brief Advances the timer wheel one tick and handles the timers that expire:
+     *        ends break animations and timed power-up effects.
+     */
+    void TimerSystem(GameWorld& world);
 
     //----------------------------------
     /// @section Entity creation functions
     //----------------------------------
 
+    /** @brief Box2D worlds that can exist at a time in the process (Box2D's B2_MAX_WORLDS). */
+    constexpr int MAX_BOX_WORLDS = 128;
+
+    /**
+     * @brief Creates the Box2D world the match's bodies live in, replacing the previous one.
+     *
+     * Box2D creates and destroys worlds through a global table, so this is serialized across
+     * threads; at most MAX_BOX_WORLDS GameWorlds can hold a Box2D world at a time.
+     *
+     * @param world The match.
+     * @param tasks Runs the solver's tasks; must outlive every step of the world.
+     * @return false (the match is left without a Box2D world) if Box2D's world table is full.
+     */
+    bool PrepareBoxWorld(GameWorld& world, PhysicsTasks& tasks);
+
     /** @brief Creates a ball entity with required components.
      *  @return The unique ID of the created entity.
      */
-    id_type CreateBall();
+    id_type CreateBall(GameWorld& world);
 
     /**
      * @brief Creates a brick entity with specific health, sprite color, and position.
      *
+     * @param world The match.
      * @param health Number of hits until the brick breaks.
      * @param color eSpriteID enum value to determine brick color.
      * @param x Horizontal position of the brick.
      * @param y Vertical position of the brick.
      * @return The unique ID of the created entity.
      */
-    id_type CreateBrick(int health, eSpriteID color, float x, float y);
+    id_type CreateBrick(GameWorld& world, int health, eSpriteID color, float x, float y);
 
     /**
      * @brief Creates a paddle controlled by the player.
      *
+     * @param world The match.
      * @param left Key code for moving left.
      * @param right Key code for moving right.
      * @return The unique ID of the created entity.
      */
-    id_type CreatePaddle(int left, int right);
+    id_type CreatePaddle(GameWorld& world, int left, int right);
 
     /**
      * @brief Creates a floor entity that detects when the ball falls below.
      *
      * @return The unique ID of the created entity.
      */
-    id_type CreateFloor();
+    id_type CreateFloor(GameWorld& world);
 
     /**
      * @brief Creates a star power-up entity at the specified position.
@@ -198,17 +268,18 @@ namespace breakout {
      * @param y Vertical position.
      * @return The unique ID of the created star entity.
      */
-    id_type CreateStar(float x, float y);
+    id_type CreateStar(GameWorld& world, float x, float y);
 
     /**
      * @brief Creates a full grid of bricks arranged in rows and columns.
      * the bricks grid contains superpower - objects.
      *
+     * @param world The match.
      * @param rows Number of brick rows.
      * @param cols Number of bricks per row.
      * @param health Health value assigned to each brick.
      */
-    void CreateBrickGrid(int rows, int cols, int health);
+    void CreateBrickGrid(GameWorld& world, int rows, int cols, int health);
 
     /**
      * @brief Creates a heart power-up entity at the specified position.
@@ -217,7 +288,7 @@ namespace breakout {
      * @param y Vertical position.
      * @return The unique ID of the created heart entity.
      */
-    id_type CreateHeart(float x, float y);
+    id_type CreateHeart(GameWorld& world, float x, float y);
 
     /**
      * @brief Creates a laser entity at the specified position.
@@ -226,15 +297,101 @@ namespace breakout {
      * @param y Vertical position.
      * @return The unique ID of the created laser entity.
      */
-    id_type CreateLaser(float x, float y);
+    id_type CreateLaser(GameWorld& world, float x, float y);
+
+    /**
+     * @brief Creates the Box2D world and a level: walls, paddle, ball, floor, a rows x cols
+     *        brick grid and warm lasers.
+     *
+     * @param world The match, empty.
+     * @param tasks Runs the solver's tasks (see PrepareBoxWorld).
+     * @param rows Rows of the brick grid.
+     * @param cols Columns of the brick grid.
+     * @return false (creating nothing) if no Box2D world could be created (see PrepareBoxWorld).
+     */
+    bool CreateLevel(GameWorld& world, PhysicsTasks& tasks, int rows, int cols);
+
+    /**
+     * @brief Saves the current level as a binary snapshot (bagel::Snapshot): every entity and
+     *        component, the brick lattice geometry, and the position, velocity and enabled state
+     *        of every Box2D body.
+     *
+     * @return false if the file could not be written.
+     */
+    bool SaveLevel(GameWorld& world, const char* path);
+
+    /**
+     * @brief Replaces the current level with one saved by SaveLevel.
+     *
+     * The World is mapped from the file without per-entity parsing; the Box2D world is recreated
+     * and its bodies rebuilt in one pass, along with the brick lattice. Timers of running break
+     * animations and power-ups restart from their full length.
+     *
+     * @param world The match.
+     * @param tasks Runs the solver's tasks of the new Box2D world.
+     * @return false (leaving the level untouched) if the file is missing or was saved by a build
+     *         with other components. Also false if its level blocks disagree with its entities
+     *         (the World then holds the file's entities but nothing else was rebuilt: load or
+     *         create a level again), or, with the match left without a Box2D world, if none
+     *         could be created (see PrepareBoxWorld).
+     */
+    bool LoadLevel(GameWorld& world, const char* path, PhysicsTasks& tasks);
 
     /**
      * @brief Runs the main game loop or core execution logic.
      *
      * @param ren The SDL renderer.
      * @param tex The texture sheet.
+     * @param tickRate Simulation ticks per second (fixed time step).
+     * @param maxFps Upper bound on rendered frames per second.
+     * @param record If not null, receives the keys of every tick and the WorldChecksum() after it
+     *               (replay it with runHeadless).
+     */
+    void run(SDL_Renderer* ren, SDL_Texture* tex, float tickRate = 60.0f, float maxFps = 60.0f,
+             InputLog* record = nullptr);
+
+    /**
+     * @brief Scripted input for headless runs.
+     *
+     * Called with the tick number and the key states of that tick (indexed by SDL_Scancode,
+     * all false on entry); set the keys that are held down.
+     */
+    using InputScript = std::function<void(int tick, bool* keys)>;
+
+    /** @brief Called after every headless tick with the tick number and the key states it used. */
+    using TickObserver = std::function<void(int tick, const bool* keys)>;
+
+    /**
+     * @brief Runs the simulation without a window, renderer or keyboard (e.g. on a CI box).
+     *
+     * @param world The match to run, empty: the level is created (or loaded) in it. Bound to the
+     *              calling thread during the run, so `observer` can read it through bagel::World.
+     * @param ticks Number of ticks to simulate.
+     * @param tickRate Simulated ticks per second (fixed deltaTime of 1 / tickRate).
+     * @param paced If true, ticks follow wall-clock time; otherwise they run as fast as possible.
+     * @param input Scripted key states for every tick.
+     * @param workers Threads shared by the systems and the Box2D solver, the caller included
+     *                (0: one per hardware thread).
+     * @param observer Called after every tick (its time is included in the result).
+     * @param level If not null, the level is loaded from this snapshot (see LoadLevel) instead of
+     *              being created.
+     * @return Wall-clock seconds spent simulating, or -1 if the level could not be created or loaded.
+     */
+    double runHeadless(GameWorld& world, int ticks, float tickRate, bool paced, const InputScript& input, int workers = 0,
+                       const TickObserver& observer = {}, const char* level = nullptr);
+
+    /**
+     * @brief Hash of the simulation state: every entity's id, generation, mask and active flag,
+     *        its simulated component values, and the position and velocity of its Box2D body.
+     *
+     * Two runs with equal checksums after the same tick have simulated exactly the same thing
+     * (bitwise equal floats), whatever the build or thread count.
+     *
+     * @param world The match to hash.
+     * @param bodies If false, Box2D bodies are left out: only the World itself is hashed (as
+     *               bagel::Rewind restores it).
      */
-    void run(SDL_Renderer* ren, SDL_Texture* tex);
+    std::uint64_t WorldChecksum(GameWorld& world, bool bodies = true);
 
 } // namespace breakout
 
@@ -0,0 +1,88 @@
+/**
+ * @file brick_lattice.cpp
+ * @brief Implementation of the static brick lattice index.
+ */
+
+#include "brick_lattice.h"
+#include <algorithm>
+#include <cmath>
+
+namespace breakout {
+
+    void BrickLattice::configure(float originX, float originY, float pitchX, float pitchY, int rows, int cols) {
+        _originX = originX;
+        _originY = originY;
+        _pitchX = pitchX;
+        _pitchY = pitchY;
+        _rows = rows;
+        _cols = cols;
+        _reachX = 0;
+        _reachY = 0;
+        _count = 0;
+        _cells.assign(static_cast<size_t>(rows) * cols, Cell{});
+    }
+
+    void BrickLattice::place(int row, int col, bagel::ent_type e, const AABB& box) {
+        if (row < 0 || row >= _rows || col < 0 || col >= _cols) return;
+
+        Cell& cell = _cells[row * _cols + col];
+        if (cell.e.id < 0) ++_count;
+        cell = {e, box};
+
+        _reachX = std::max(_reachX, static_cast<int>(std::ceil((box.maxX - box.minX) / _pitchX)) - 1);
+        _reachY = std::max(_reachY, static_cast<int>(std::ceil((box.maxY - box.minY) / _pitchY)) - 1);
+    }
+
+    void BrickLattice::place(bagel::ent_type e, const Position& pos, const AABB& box) {
+        int cell = cellOf(pos);
+        if (cell >= 0) place(cell / _cols, cell % _cols, e, box);
+    }
+
+    void BrickLattice::remove(bagel::ent_type e, const Position& pos) {
+        int index = cellOf(pos);
+        if (index < 0) return;
+
+        Cell& cell = _cells[index];
+        if (cell.e != e) return;
+        cell = Cell{};
+        --_count;
+    }
+
+    void BrickLattice::queryAABB(const AABB& box, std::vector<bagel::ent_type>& out) const {
+        out.clear();
+        if (_count == 0) return;
+
+        int col0 = std::max(0, colOf(box.minX) - _reachX);
+        int col1 = std::min(_cols - 1, colOf(box.maxX));
+        int row0 = std::max(0, rowOf(box.minY) - _reachY);
+        int row1 = std::min(_rows - 1, rowOf(box.maxY));
+
+        for (int row = row0; row <= row1; ++row) {
+            for (int col = col0; col <= col1; ++col) {
+                const Cell& cell = _cells[row * _cols + col];
+                if (cell.e.id < 0) continue;
+                if (box.minX < cell.box.maxX && box.maxX > cell.box.minX &&
+                    box.minY < cell.box.maxY && box.maxY > cell.box.minY) {
+                    out.push_back(cell.e);
+                }
+            }
+        }
+    }
+
+    int BrickLattice::colOf(float x) const {
+        return static_cast<int>(std::floor((x - _originX) / _pitchX));
+    }
+
+    int BrickLattice::rowOf(float y) const {
+        return static_cast<int>(std::floor((y - _originY) / _pitchY));
+    }
+
+    /** @brief Row-major index of the cell anchored nearest to `pos`, or -1 outside the lattice. */
+    int BrickLattice::cellOf(const Position& pos) const {
+        int col = static_cast<int>(std::floor((pos.x - _originX) / _pitchX + 0.5f));
+        int row = static_cast<int>(std::floor((pos.y - _originY) / _pitchY + 0.5f));
+        if (row < 0 || row >= _rows || col < 0 || col >= _cols) return -1;
+        return row * _cols + col;
+    }
+
+} // namespace breakout
@@ -0,0 +1,116 @@
+/**
+ * @file brick_lattice.h
+ * @brief Static index of the brick grid: O(1) brick lookup by lattice cell.
+ *
+ * CreateBrickGrid lays bricks (and the star/heart power-ups) on a regular lattice.
+ * The lattice maps each cell to the entity occupying it, so an AABB query only
+ * visits the few cells the box covers instead of scanning every brick.
+ *
+ * It is CollisionSystem's broad phase for lasers: queryAABB returns the candidates their
+ * narrow phase (an AABB test) runs against. Balls have Box2D bodies and rely on Box2D's own
+ * broad phase, whose contact events CollisionSystem reads.
+ */
+#ifndef BRICK_LATTICE_H
+#define BRICK_LATTICE_H
+
+#include "breakout_game.h"
+#include <vector>
+
+namespace breakout {
+
+    /** @brief Axis-aligned bounding box in screen pixels. */
+    struct AABB {
+        float minX = 0.0f;
+        float minY = 0.0f;
+        float maxX = 0.0f;
+        float maxY = 0.0f;
+    };
+
+    /** @brief Builds the AABB of an entity from its Position and Collider. */
+    inline AABB MakeAABB(const Position& pos, const Collider& col) {
+        return {pos.x, pos.y, pos.x + col.width, pos.y + col.height};
+    }
+
+    /**
+     * @brief Maps lattice cells (row, col) to the entity placed there.
+     *
+     * Occupants are anchored at their cell's top-left corner. An occupant larger than
+     * a cell extends into the following cells; queries widen their range accordingly.
+     */
+    class BrickLattice {
+    public:
+        /**
+         * @brief Resets the lattice to an empty grid with the given geometry.
+         *
+         * @param originX Screen X of column 0.
+         * @param originY Screen Y of row 0.
+         * @param pitchX Horizontal distance between two columns (brick width + spacing).
+         * @param pitchY Vertical distance between two rows (brick height + spacing).
+         * @param rows Number of rows.
+         * @param cols Number of columns.
+         */
+        void configure(float originX, float originY, float pitchX, float pitchY, int rows, int cols);
+
+        /** @brief Arguments of the last configure() call. */
+        struct Geometry {
+            float originX, originY, pitchX, pitchY;
+            int rows, cols;
+        };
+
+        /** @brief Geometry of the lattice, to configure another one the same way. */
+        Geometry geometry() const { return {_originX, _originY, _pitchX, _pitchY, _rows, _cols}; }
+
+        /** @brief Places an entity with the given AABB in cell (row, col). */
+        void place(int row, int col, bagel::ent_type e, const AABB& box);
+
+        /**
+         * @brief Places an entity in the cell anchored at its position (as found by remove()),
+         *        e.g. to index entities restored from a snapshot.
+         */
+        void place(bagel::ent_type e, const Position& pos, const AABB& box);
+
+        /**
+         * @brief Removes an entity from the lattice, if it is indexed at the given position.
+         *
+         * @param e The retiring entity.
+         * @param pos Its Position (the top-left corner of its cell).
+         */
+        void remove(bagel::ent_type e, const Position& pos);
+
+        /**
+         * @brief Collects the indexed entities whose AABB overlaps the given box.
+         *
+         * @param box Query box.
+         * @param out Receives the overlapping entities (cleared first).
+         */
+        void queryAABB(const AABB& box, std::vector<bagel::ent_type>& out) const;
+
+        /** @brief Number of occupied cells. */
+        int size() const { return _count; }
+
+    private:
+        struct Cell {
+            bagel::ent_type e{-1};
+            AABB box;
+        };
+
+        int colOf(float x) const;
+        int rowOf(float y) const;
+        int cellOf(const Position& pos) const;
+
+        float _originX = 0.0f;
+        float _originY = 0.0f;
+        float _pitchX = 1.0f;
+        float _pitchY = 1.0f;
+        int _rows = 0;
+        int _cols = 0;
+        int _reachX = 0;    ///< Extra columns an occupant may extend into
+        int _reachY = 0;    ///< Extra rows an occupant may extend into
+        int _count = 0;
+
+        std::vector<Cell> _cells;  ///< Row-major, _rows * _cols cells
+    };
+
+} // namespace breakout
+
+#endif // BRICK_LATTICE_H
@@ -0,0 +1,87 @@
+/**
+ * @file game_world.h
+ * @brief Everything one running match owns: its bagel World, its Box2D world and the game
+ *        state kept next to them.
+ *
+ * The systems and entity creation functions of breakout_game.h work on the GameWorld they are
+ * given, so several matches can run in one process, each on its own thread.
+ */
+#ifndef GAME_WORLD_H
+#define GAME_WORLD_H
+
+#include "breakout_game.h"
+#include "brick_lattice.h"
+#include "static_layer.h"
+#include "../bagel.h"
+#include "../bagel_timer.h"
+#include <box2d/box2d.h>
+#include <vector>
+
+namespace breakout {
+
+    /**
+     * @brief State of one match.
+     *
+     * A GameWorld is used by one thread at a time (the systems of its scheduler included).
+     * The game functions bind `ecs` to the calling thread while they run, so bagel's static
+     * API reaches this match's entities.
+     *
+     * A bagel::Rewind on `ecs` only restores the World: `boxWorld`, `laserPool`, `timers` and
+     * the other members keep their latest state. After a rollback the match can be inspected
+     * (or rolled forward again to its latest tick) but must not be simulated further.
+     */
+    struct GameWorld {
+        GameWorld();
+        ~GameWorld();
+        GameWorld(const GameWorld&) = delete;
+        GameWorld& operator=(const GameWorld&) = delete;
+
+        /** @brief Entities and components of the match (declared first: destroyed last). */
+        bagel::World ecs;
+
+        /** @brief Box2D world the match's bodies live in (see PrepareBoxWorld). */
+        b2WorldId boxWorld = b2_nullWorldId;
+
+        /** @brief Lattice index of the bricks and power-ups laid out by CreateBrickGrid. */
+        BrickLattice brickLattice;
+
+        /** @brief Cached render layer holding the bricks of the brick grid (see RenderSystem). */
+        StaticLayer brickLayer;
+
+        /**
+         * @brief Entity owning each Box2D body, indexed by b2BodyId::index1.
+         *
+         * Box2D keeps body indices compact (a destroyed body's index is reused), so this stays as
+         * small as the number of live bodies. Unused slots hold id -1.
+         */
+        std::vector<bagel::ent_type> bodyEntities;
+
+        /**
+         * @brief Prebuilt laser entities, parked above the screen while inactive.
+         *
+         * Firing activates one (see SpawnLaser) and MovementSystem deactivates it once it leaves
+         * the screen, so shooting makes no structural change to the World.
+         */
+        bagel::EntityPool laserPool;
+
+        /**
+         * @brief Expiry timers of break animations and timed effects, advanced once per tick by TimerSystem.
+         *
+         * Scheduling and cancelling are O(1), and a tick only visits the timers that expire on it,
+         * instead of every animating brick and powered-up paddle being counted down each tick.
+         */
+        bagel::TimerWheel timers;
+
+        /** @brief Length of one `timers` tick (seconds): the simulation time step, set by AddSystems. */
+        float timerTick = 1.0f / 60.0f;
+
+        /** @brief Time left before the laser power-up fires again (seconds, see PowerUpSystem). */
+        float laserCooldown = 0.0f;
+
+        /** @brief Scratch list of the bricks a laser overlaps (see CollisionSystem). */
+        std::vector<bagel::ent_type> candidates;
+    };
+
+} // namespace breakout
+
+#endif // GAME_WORLD_H
@@ -0,0 +1,101 @@
+/**
+ * @file input_log.cpp
+ * @brief Implementation of InputLog: recording, replay and file I/O.
+ */
+
+#include "input_log.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace breakout {
+
+    constexpr char MAGIC[4] = {'B', 'G', 'I', 'L'};
+    constexpr std::uint32_t VERSION = 1;
+    constexpr std::uint32_t KEY_COUNT = sizeof(InputLog::KEYS) / sizeof(InputLog::KEYS[0]);
+    static_assert(KEY_COUNT <= 8, "InputLog keeps the keys of a tick in one byte");
+
+    template <class T>
+    static bool Write(FILE* f, const T* data, size_t count) {
+        return std::fwrite(data, sizeof(T), count, f) == count;
+    }
+
+    template <class T>
+    static bool Read(FILE* f, T* data, size_t count) {
+        return std::fread(data, sizeof(T), count, f) == count;
+    }
+
+    /** @brief Bytes between the read position and the end of the file, or -1 if unknown. */
+    static long Remaining(FILE* f) {
+        const long at = std::ftell(f);
+        if (at < 0 || std::fseek(f, 0, SEEK_END) != 0) return -1;
+        const long end = std::ftell(f);
+        return std::fseek(f, at, SEEK_SET) == 0 ? end - at : -1;
+    }
+
+    void InputLog::record(const bool* keys, std::uint64_t checksum) {
+        std::uint8_t bits = 0;
+        for (std::uint32_t i = 0; i < KEY_COUNT; ++i) {
+            if (keys[KEYS[i]]) bits |= static_cast<std::uint8_t>(1u << i);
+        }
+        _keys.push_back(bits);
+        _checksums.push_back(checksum);
+    }
+
+    void InputLog::apply(int tick, bool* keys) const {
+        for (std::uint32_t i = 0; i < KEY_COUNT; ++i) {
+            if (_keys[tick] & (1u << i)) keys[KEYS[i]] = true;
+        }
+    }
+
+    bool InputLog::save(const char* path) const {
+        FILE* f = std::fopen(path, "wb");
+        if (f == nullptr) return false;
+
+        std::int32_t scancodes[KEY_COUNT];
+        for (std::uint32_t i = 0; i < KEY_COUNT; ++i) scancodes[i] = KEYS[i];
+        const std::uint32_t count = static_cast<std::uint32_t>(_keys.size());
+
+        bool ok = Write(f, MAGIC, 4) && Write(f, &VERSION, 1) && Write(f, &_tickRate, 1) &&
+                  Write(f, &KEY_COUNT, 1) && Write(f, scancodes, KEY_COUNT) && Write(f, &count, 1) &&
+                  Write(f, _keys.data(), count) && Write(f, _checksums.data(), count);
+        return std::fclose(f) == 0 && ok;
+    }
+
+    bool InputLog::load(const char* path) {
+        FILE* f = std::fopen(path, "rb");
+        if (f == nullptr) return false;
+
+        char magic[4];
+        std::uint32_t version = 0, keyCount = 0, count = 0;
+        std::int32_t scancodes[KEY_COUNT];
+        float tickRate = 0.0f;
+
+        bool ok = Read(f, magic, 4) && std::memcmp(magic, MAGIC, 4) == 0 &&
+                  Read(f, &version, 1) && version == VERSION && Read(f, &tickRate, 1) &&
+                  tickRate > 0.0f && std::isfinite(tickRate) && Read(f, &keyCount, 1) && keyCount == KEY_COUNT && Read(f, scancodes, KEY_COUNT);
+        for (std::uint32_t i = 0; ok && i < KEY_COUNT; ++i) ok = scancodes[i] == KEYS[i];
+
+        std::vector<std::uint8_t> keys;
+        std::vector<std::uint64_t> checksums;
+        // A corrupt count must not be allocated: the file holds 9 bytes per tick
+        constexpr long TICK_BYTES = sizeof(std::uint8_t) + sizeof(std::uint64_t);
+        if (ok && Read(f, &count, 1) && static_cast<long long>(count) <= Remaining(f) / TICK_BYTES) {
+            keys.resize(count);
+            checksums.resize(count);
+            ok = Read(f, keys.data(), count) && Read(f, checksums.data(), count);
+        }
+        else {
+            ok = false;
+        }
+        std::fclose(f);
+        if (!ok) return false;
+
+        _tickRate = tickRate;
+        _keys = std::move(keys);
+        _checksums = std::move(checksums);
+        return true;
+    }
+
+} // namespace breakout
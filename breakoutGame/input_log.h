@@ -0,0 +1,70 @@
+/**
+ * @file input_log.h
+ * @brief Per-tick input recording, for replaying a run deterministically.
+ *
+ * The simulation advances in fixed ticks of 1 / tickRate seconds and its only outside input
+ * is the keyboard state read at each tick, so the keys of every tick (and the tick rate) are
+ * all a replay needs. Each tick also keeps the WorldChecksum() taken after it, so a replay can
+ * verify that it reproduces the recorded simulation exactly.
+ */
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include "SDL3_image/SDL_image.h"
+#include <cstdint>
+#include <vector>
+
+namespace breakout {
+
+    /**
+     * @brief Recorded key states and world checksums, one entry per tick.
+     *
+     * File layout (native byte order): "BGIL", version, tick rate, the recorded scancodes,
+     * the tick count, one byte of key bits per tick, then one 64-bit checksum per tick.
+     */
+    class InputLog {
+    public:
+        /** @brief Keys recorded; bit i of a tick's byte is KEYS[i]. */
+        static constexpr SDL_Scancode KEYS[] = {SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT};
+
+        explicit InputLog(float tickRate = 60.0f) : _tickRate(tickRate) {}
+
+        /**
+         * @brief Appends one tick.
+         *
+         * @param keys Key states of the tick, indexed by SDL_Scancode.
+         * @param checksum WorldChecksum() after the tick.
+         */
+        void record(const bool* keys, std::uint64_t checksum);
+
+        /** @brief Sets the keys held during `tick` (other keys are left untouched). */
+        void apply(int tick, bool* keys) const;
+
+        /** @brief WorldChecksum() recorded after `tick`. */
+        std::uint64_t checksum(int tick) const { return _checksums[tick]; }
+
+        /** @brief Number of ticks recorded. */
+        int ticks() const { return static_cast<int>(_keys.size()); }
+
+        /** @brief Ticks per second of the recorded run. */
+        float tickRate() const { return _tickRate; }
+
+        /** @brief Writes the log to a file. @return false if the file could not be written. */
+        bool save(const char* path) const;
+
+        /**
+         * @brief Replaces the log with the content of a file.
+         * @return false if the file is missing, truncated, corrupt (more ticks than it holds, a
+         *         tick rate that is not a positive number), or records other keys.
+         */
+        bool load(const char* path);
+
+    private:
+        float _tickRate;
+        std::vector<std::uint8_t> _keys;       ///< Key bits of each tick
+        std::vector<std::uint64_t> _checksums; ///< WorldChecksum() after each tick
+    };
+
+} // namespace breakout
+
+#endif // INPUT_LOG_H
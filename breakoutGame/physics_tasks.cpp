@@ -0,0 +1,63 @@
+/**
+ * @file physics_tasks.cpp
+ * @brief Implementation of the Box2D task callbacks.
+ */
+
+#include "physics_tasks.h"
+#include <algorithm>
+
+namespace breakout {
+
+    void PhysicsTasks::configure(b2WorldDef& def) {
+        def.workerCount = _jobs.workerCount();
+        def.enqueueTask = &PhysicsTasks::enqueue;
+        def.finishTask = &PhysicsTasks::finish;
+        def.userTaskContext = this;
+    }
+
+    // Box2D enqueues and finishes tasks from the thread running b2World_Step only,
+    // so the task pool needs no locking.
+    void* PhysicsTasks::enqueue(b2TaskCallback* task, int itemCount, int minRange, void* taskContext, void* userContext) {
+        auto& self = *static_cast<PhysicsTasks*>(userContext);
+
+        const int workers = self._jobs.workerCount();
+
+        // Nobody to share with: run it now, nullptr tells Box2D there is nothing to finish.
+        // Otherwise even a single item goes to the pool: the solver enqueues one long-running
+        // task per worker and they only make progress side by side.
+        if (workers == 1) {
+            task(0, itemCount, 0, taskContext);
+            return nullptr;
+        }
+        const int chunk = std::max(std::max(minRange, 1), (itemCount + workers - 1) / workers);
+
+        if (self._free.empty()) {
+            self._tasks.push_back(std::make_unique<Task>());
+            self._free.push_back(self._tasks.back().get());
+        }
+        Task* t = self._free.back();
+        self._free.pop_back();
+        t->fn = task;
+        t->ctx = taskContext;
+
+        for (int begin = 0; begin < itemCount; begin += chunk) {
+            self._jobs.submit(&PhysicsTasks::runRange, t, begin, std::min(begin + chunk, itemCount), &t->done);
+        }
+        return t;
+    }
+
+    void PhysicsTasks::finish(void* userTask, void* userContext) {
+        auto& self = *static_cast<PhysicsTasks*>(userContext);
+        auto* t = static_cast<Task*>(userTask);
+
+        // Helps running jobs (this task's or any other) until every range is done
+        self._jobs.wait(t->done);
+        self._free.push_back(t);
+    }
+
+    void PhysicsTasks::runRange(void* ctx, bagel::index_type begin, bagel::index_type end, bagel::index_type worker) {
+        auto* t = static_cast<Task*>(ctx);
+        t->fn(begin, end, static_cast<uint32_t>(worker), t->ctx);
+    }
+
+} // namespace breakout
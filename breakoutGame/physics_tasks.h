@@ -0,0 +1,59 @@
+/**
+ * @file physics_tasks.h
+ * @brief Runs Box2D's parallel solver tasks on the bagel JobSystem.
+ *
+ * Box2D splits its step into tasks and hands them to the application through the
+ * enqueueTask / finishTask callbacks of b2WorldDef. PhysicsTasks implements them on
+ * the same work-stealing pool that runs the ECS systems, so physics islands are solved
+ * in parallel without a second set of threads competing for the cores.
+ */
+#ifndef PHYSICS_TASKS_H
+#define PHYSICS_TASKS_H
+
+#include "breakout_game.h"
+#include "../bagel_sched.h"
+#include <memory>
+#include <vector>
+
+namespace breakout {
+
+    /**
+     * @brief Box2D task callbacks backed by a bagel::JobSystem.
+     *
+     * Usage: configure() the b2WorldDef before b2CreateWorld; the PhysicsTasks (and its
+     * JobSystem) must outlive every b2World_Step of that world.
+     */
+    class PhysicsTasks {
+    public:
+        explicit PhysicsTasks(bagel::JobSystem& jobs) : _jobs(jobs) {}
+        PhysicsTasks(const PhysicsTasks&) = delete;
+        PhysicsTasks& operator=(const PhysicsTasks&) = delete;
+
+        /**
+         * @brief Installs the task callbacks in a world definition.
+         *
+         * The Box2D worker count is the size of the pool: Box2D indexes its per-worker
+         * scratch data with the pool's worker index, which is below workerCount().
+         */
+        void configure(b2WorldDef& def);
+
+    private:
+        /** @brief One enqueued Box2D task, split into jobs that all decrement `done`. */
+        struct Task {
+            b2TaskCallback* fn = nullptr;
+            void* ctx = nullptr;
+            bagel::JobSystem::Counter done{0};
+        };
+
+        static void* enqueue(b2TaskCallback* task, int itemCount, int minRange, void* taskContext, void* userContext);
+        static void finish(void* userTask, void* userContext);
+        static void runRange(void* ctx, bagel::index_type begin, bagel::index_type end, bagel::index_type worker);
+
+        bagel::JobSystem& _jobs;
+        std::vector<std::unique_ptr<Task>> _tasks; ///< Every task ever allocated
+        std::vector<Task*> _free;                  ///< Tasks not in flight
+    };
+
+} // namespace breakout
+
+#endif // PHYSICS_TASKS_H
@@ -0,0 +1,36 @@
+/**
+ * @file sprite_batch.cpp
+ * @brief Implementation of the batched sprite renderer.
+ */
+
+#include "sprite_batch.h"
+#include <algorithm>
+
+namespace breakout {
+
+    void SpriteBatch::add(const SDL_FRect& dst, const SpriteUV& uv) {
+        const int first = _quads * 4;
+        if (first + 4 > static_cast<int>(_vertices.size())) {
+            int quads = std::max(64, _quads * 2);
+            _vertices.resize(quads * 4);
+            for (int q = static_cast<int>(_indices.size()) / 6; q < quads; ++q) {
+                const int v = q * 4;
+                _indices.insert(_indices.end(), {v, v + 1, v + 2, v, v + 2, v + 3});
+            }
+        }
+
+        const SDL_FColor white{1.0f, 1.0f, 1.0f, 1.0f};
+        SDL_Vertex* v = &_vertices[first];
+        v[0] = {{dst.x, dst.y}, white, {uv.u0, uv.v0}};
+        v[1] = {{dst.x + dst.w, dst.y}, white, {uv.u1, uv.v0}};
+        v[2] = {{dst.x + dst.w, dst.y + dst.h}, white, {uv.u1, uv.v1}};
+        v[3] = {{dst.x, dst.y + dst.h}, white, {uv.u0, uv.v1}};
+        ++_quads;
+    }
+
+    void SpriteBatch::draw(SDL_Renderer* ren, SDL_Texture* tex) const {
+        if (_quads == 0) return;
+        SDL_RenderGeometry(ren, tex, _vertices.data(), _quads * 4, _indices.data(), _quads * 6);
+    }
+
+} // namespace breakout
@@ -0,0 +1,59 @@
+/**
+ * @file sprite_batch.h
+ * @brief Batches textured quads from one sprite sheet into a single SDL_RenderGeometry call.
+ */
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include "SDL3_image/SDL_image.h"
+#include <vector>
+
+namespace breakout {
+
+    /** @brief Normalized texture coordinates of a sprite inside its sheet. */
+    struct SpriteUV {
+        float u0 = 0.0f;
+        float v0 = 0.0f;
+        float u1 = 0.0f;
+        float v1 = 0.0f;
+    };
+
+    /** @brief Converts a source rectangle in sheet pixels to texture coordinates. */
+    inline SpriteUV MakeUV(const SDL_FRect& src, float sheetW, float sheetH) {
+        return {src.x / sheetW, src.y / sheetH, (src.x + src.w) / sheetW, (src.y + src.h) / sheetH};
+    }
+
+    /**
+     * @brief Collects sprite quads for one frame and submits them with one draw call.
+     *
+     * Vertex and index storage persist between frames. The index buffer holds the fixed
+     * two-triangles-per-quad pattern and is only extended when the batch outgrows it.
+     */
+    class SpriteBatch {
+    public:
+        /** @brief Starts a new frame (keeps the allocated buffers). */
+        void clear() { _quads = 0; }
+
+        /**
+         * @brief Appends a quad.
+         *
+         * @param dst Destination rectangle in screen pixels.
+         * @param uv Texture coordinates of the sprite.
+         */
+        void add(const SDL_FRect& dst, const SpriteUV& uv);
+
+        /** @brief Draws every quad added since clear() with a single SDL_RenderGeometry call. */
+        void draw(SDL_Renderer* ren, SDL_Texture* tex) const;
+
+        /** @brief Number of quads in the batch. */
+        int size() const { return _quads; }
+
+    private:
+        std::vector<SDL_Vertex> _vertices;
+        std::vector<int> _indices;
+        int _quads = 0;
+    };
+
+} // namespace breakout
+
+#endif // SPRITE_BATCH_H
@@ -0,0 +1,86 @@
+/**
+ * @file static_layer.cpp
+ * @brief Implementation of the cached static sprite layer.
+ */
+
+#include "static_layer.h"
+#include <cmath>
+
+namespace breakout {
+
+    void StaticLayer::invalidate(const SDL_FRect& rect) {
+        if (_full) return; // a full rebuild is pending anyway
+        _dirty.push_back(rect);
+    }
+
+    void StaticLayer::invalidateAll() {
+        _full = true;
+        _dirty.clear();
+    }
+
+    void StaticLayer::update(SDL_Renderer* ren, SDL_Texture* sheet, const Fill& fill) {
+        if (!_full && _dirty.empty()) return;
+
+        if (_target == nullptr) {
+            int w = 0, h = 0;
+            SDL_GetRenderOutputSize(ren, &w, &h);
+            _target = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+            if (_target == nullptr) return;
+            SDL_SetTextureBlendMode(_target, SDL_BLENDMODE_BLEND);
+            _width = static_cast<float>(w);
+            _height = static_cast<float>(h);
+            _full = true;
+        }
+
+        SDL_SetRenderTarget(ren, _target);
+        if (_full) {
+            redraw(ren, sheet, {0.0f, 0.0f, _width, _height}, fill);
+        }
+        else {
+            for (const SDL_FRect& rect : _dirty) {
+                redraw(ren, sheet, rect, fill);
+            }
+        }
+        SDL_SetRenderClipRect(ren, nullptr);
+        SDL_SetRenderTarget(ren, nullptr);
+
+        _full = false;
+        _dirty.clear();
+    }
+
+    /**
+     * Clears the region to transparent and draws the static sprites overlapping it.
+     * The clip rectangle keeps neighbouring sprites from being drawn twice outside the region.
+     */
+    void StaticLayer::redraw(SDL_Renderer* ren, SDL_Texture* sheet, const SDL_FRect& region, const Fill& fill) {
+        SDL_Rect clip{static_cast<int>(std::floor(region.x)), static_cast<int>(std::floor(region.y)), 0, 0};
+        clip.w = static_cast<int>(std::ceil(region.x + region.w)) - clip.x;
+        clip.h = static_cast<int>(std::ceil(region.y + region.h)) - clip.y;
+        SDL_SetRenderClipRect(ren, &clip);
+
+        SDL_FRect area{static_cast<float>(clip.x), static_cast<float>(clip.y),
+                       static_cast<float>(clip.w), static_cast<float>(clip.h)};
+        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(ren, 0, 0, 0, 0);
+        SDL_RenderFillRect(ren, &area);
+
+        _batch.clear();
+        fill(area, _batch);
+        _batch.draw(ren, sheet);
+    }
+
+    void StaticLayer::draw(SDL_Renderer* ren) const {
+        if (_target == nullptr) return;
+        SDL_RenderTexture(ren, _target, nullptr, nullptr);
+    }
+
+    void StaticLayer::release() {
+        if (_target != nullptr) {
+            SDL_DestroyTexture(_target);
+            _target = nullptr;
+        }
+        _full = true;
+        _dirty.clear();
+    }
+
+} // namespace breakout
@@ -0,0 +1,72 @@
+/**
+ * @file static_layer.h
+ * @brief Render-target cache for sprites that never move (the brick grid).
+ *
+ * The layer is drawn once into a screen-sized target texture and composited with a
+ * single draw call every frame. When a cached sprite changes or disappears, only
+ * the invalidated rectangles are cleared and drawn again.
+ */
+#ifndef STATIC_LAYER_H
+#define STATIC_LAYER_H
+
+#include "sprite_batch.h"
+#include <functional>
+#include <vector>
+
+namespace breakout {
+
+    /**
+     * @brief Cached layer of static sprites.
+     *
+     * Usage per frame: invalidate() what changed, update() with a callback that adds the
+     * static sprites of a region to a batch, then draw() before the dynamic sprites.
+     * The owner calls invalidateAll() on SDL_EVENT_RENDER_TARGETS_RESET (the target's contents
+     * are lost) and release() on SDL_EVENT_RENDER_DEVICE_RESET or when the output is resized.
+     */
+    class StaticLayer {
+    public:
+        /** @brief Adds every static sprite overlapping the region to the batch. */
+        using Fill = std::function<void(const SDL_FRect& region, SpriteBatch& batch)>;
+
+        StaticLayer() = default;
+        StaticLayer(const StaticLayer&) = delete;
+        StaticLayer& operator=(const StaticLayer&) = delete;
+        ~StaticLayer() { release(); }
+
+        /** @brief Marks a screen rectangle for redrawing. */
+        void invalidate(const SDL_FRect& rect);
+
+        /** @brief Marks the whole layer for redrawing. */
+        void invalidateAll();
+
+        /**
+         * @brief Redraws the invalidated parts of the layer into its target texture.
+         *
+         * Creates the target (the size of the renderer output) on first use.
+         *
+         * @param ren The SDL renderer.
+         * @param sheet Sprite sheet the batch refers to.
+         * @param fill Callback adding the static sprites of a region.
+         */
+        void update(SDL_Renderer* ren, SDL_Texture* sheet, const Fill& fill);
+
+        /** @brief Draws the layer over the whole render output. */
+        void draw(SDL_Renderer* ren) const;
+
+        /** @brief Destroys the target texture; the next update() rebuilds the layer. */
+        void release();
+
+    private:
+        void redraw(SDL_Renderer* ren, SDL_Texture* sheet, const SDL_FRect& region, const Fill& fill);
+
+        SDL_Texture* _target = nullptr;
+        float _width = 0.0f;
+        float _height = 0.0f;
+        bool _full = true;
+        std::vector<SDL_FRect> _dirty;
+        SpriteBatch _batch;
+    };
+
+} // namespace breakout
+
+#endif // STATIC_LAYER_H
@@ -1,9 +1,22 @@
 #include "breakoutGame/breakout_game.h"
+#include "breakoutGame/game_world.h"
+#include "breakoutGame/input_log.h"
+#include "breakoutGame/physics_tasks.h"
 #include "bagel.h"
+#include "bagel_rewind.h"
+#include "bagel_sched.h"
 
 #include "lib/SDL/include/SDL3/SDL.h"
 #include "lib/SDL_image/include/SDL3_image/SDL_image.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
 
 /**
  * @brief Initializes SDL, creates a window and renderer, and loads the texture sheet.
@@ -38,7 +51,237 @@ void cleanUp(SDL_Window* window, SDL_Renderer* renderer, SDL_Texture* sheet) {
     SDL_Quit();
 }
 
-int main() {
+/** @brief Scripted input of headless runs: the paddle sweeps right and left every 1.5 simulated seconds. */
+static void sweepPaddle(int tick, bool* keys) {
+    keys[(tick / 90) % 2 == 0 ? SDL_SCANCODE_RIGHT : SDL_SCANCODE_LEFT] = true;
+}
+
+/**
+ * @brief Runs independent matches on a fixed pool of threads (one per hardware thread, at most
+ * breakout::MAX_BOX_WORLDS) and prints their aggregate tick rate.
+ *
+ * Each thread plays matches one after the other until all are done, every match in its own
+ * GameWorld simulated by that thread alone (no JobSystem workers). A GameWorld is destroyed when
+ * its match ends, so no more Box2D worlds are alive at a time than there are threads, whatever
+ * the number of matches.
+ */
+int runMatches(int matches, int ticks, const char* levelPath) {
+    const int hardware = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int threadCount = std::min({matches, hardware, breakout::MAX_BOX_WORLDS});
+    std::atomic<int> next{0};
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> threads;
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&next, &failed, matches, ticks, levelPath] {
+            for (int m = next++; m < matches && !failed; m = next++) {
+                breakout::GameWorld world;
+                if (breakout::runHeadless(world, ticks, 60.0f, false, sweepPaddle, 1, {}, levelPath) < 0.0) failed = true;
+            }
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    const double wall = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (failed) {
+        std::cerr << "Failed to " << (levelPath ? "load level " : "create the level") << (levelPath ? levelPath : "") << "\n";
+        return 1;
+    }
+    std::cout << matches << " matches x " << ticks << " ticks on " << threadCount << " threads in " << wall << " s ("
+              << matches * static_cast<double>(ticks) / wall << " ticks/s in total)\n";
+    return 0;
+}
+
+/**
+ * @brief Runs the simulation without SDL:
+ * `BAGEL --headless [ticks] [--paced] [--workers N] [--record file] [--level file] [--matches N]`.
+ *
+ * The paddle sweeps right and left every 1.5 simulated seconds. Prints the achieved tick rate.
+ * With --record, the input and checksum of every tick are saved for --replay. With --level,
+ * the run starts from a level snapshot written by --save-level. With --matches, N independent
+ * matches run side by side on a pool of threads (see runMatches).
+ */
+int runHeadless(int argc, char* argv[]) {
+    int ticks = 10000;
+    bool paced = false;
+    int workers = 0;
+    int matches = 0;
+    const char* recordPath = nullptr;
+    const char* levelPath = nullptr;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--paced") == 0) paced = true;
+        else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) workers = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordPath = argv[++i];
+        else if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc) levelPath = argv[++i];
+        else if (std::strcmp(argv[i], "--matches") == 0 && i + 1 < argc) matches = std::atoi(argv[++i]);
+        else ticks = std::atoi(argv[i]);
+    }
+    if (matches > 0) return runMatches(matches, ticks, levelPath);
+
+    breakout::GameWorld world;
+    breakout::InputLog log(60.0f);
+    breakout::TickObserver observer;
+    if (recordPath) {
+        observer = [&log, &world](int, const bool* keys) { log.record(keys, breakout::WorldChecksum(world)); };
+    }
+
+    double seconds = breakout::runHeadless(world, ticks, 60.0f, paced, sweepPaddle, workers, observer, levelPath);
+    if (seconds < 0.0) {
+        std::cerr << "Failed to " << (levelPath ? "load level " : "create the level") << (levelPath ? levelPath : "") << "\n";
+        return 1;
+    }
+
+    std::cout << ticks << " ticks in " << seconds << " s (" << ticks / seconds << " ticks/s)\n";
+    if (recordPath && !log.save(recordPath)) {
+        std::cerr << "Failed to write " << recordPath << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Replays a recorded run without SDL:
+ * `BAGEL --replay file [--verify] [--paced] [--workers N] [--rewind K]`.
+ *
+ * Feeds the recorded keys to the same fixed ticks, so the simulation (Box2D included) repeats
+ * the recorded one. Prints the achieved tick rate; with --verify, also compares WorldChecksum()
+ * with the recorded one after every tick and fails on the first difference. With --rewind
+ * (BAGEL_REWIND builds), the World is then rolled back K ticks and forward again, checking
+ * that it matches the ticks it returns to and printing how long each took.
+ */
+int runReplay(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --replay file [--verify] [--paced] [--workers N] [--rewind K]\n";
+        return 1;
+    }
+    bool verify = false;
+    bool paced = false;
+    int workers = 0;
+    int rewindTicks = 0;
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--verify") == 0) verify = true;
+        else if (std::strcmp(argv[i], "--paced") == 0) paced = true;
+        else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) workers = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--rewind") == 0 && i + 1 < argc) rewindTicks = std::atoi(argv[++i]);
+    }
+    if (rewindTicks > 0 && !bagel::Rewind::Enabled) {
+        std::cerr << "--rewind needs a build with BAGEL_REWIND (cmake -DBAGEL_REWIND=ON)\n";
+        return 1;
+    }
+
+    breakout::InputLog log;
+    if (!log.load(argv[2])) {
+        std::cerr << "Failed to read input log " << argv[2] << "\n";
+        return 1;
+    }
+
+    const int ticks = log.ticks();
+    if (rewindTicks >= ticks) rewindTicks = ticks - 1;
+
+    // Box2D is not part of the World: rewinding is checked against World-only checksums.
+    // The Rewind is only attached with --rewind, as it makes every tracked write take its lock.
+    breakout::GameWorld world;
+    std::unique_ptr<bagel::Rewind> rewind;
+    if (rewindTicks > 0) rewind = std::make_unique<bagel::Rewind>(size_t{256} << 20, rewindTicks, world.ecs);
+    std::vector<std::uint64_t> worldChecksums;
+
+    int firstMismatch = -1;
+    breakout::TickObserver observer = [&](int tick, const bool*) {
+        if (verify && firstMismatch < 0 && breakout::WorldChecksum(world) != log.checksum(tick)) firstMismatch = tick;
+        if (rewind) {
+            rewind->commit();
+            worldChecksums.push_back(breakout::WorldChecksum(world, false));
+        }
+    };
+
+    double seconds = breakout::runHeadless(world, ticks, log.tickRate(), paced, [&log](int tick, bool* keys) {
+        log.apply(tick, keys);
+    }, workers, observer);
+    if (seconds < 0.0) {
+        std::cerr << "Failed to create the level\n";
+        return 1;
+    }
+
+    std::cout << ticks << " ticks in " << seconds << " s (" << ticks / seconds << " ticks/s)\n";
+    if (firstMismatch >= 0) {
+        std::cout << "Replay diverged from the recording at tick " << firstMismatch << "\n";
+        return 1;
+    }
+    if (verify) std::cout << "Replay matches the recording (" << ticks << " checksums)\n";
+    if (!rewind) return 0;
+
+    using Clock = std::chrono::steady_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+    const size_t bytes = rewind->bytes();
+    const Clock::time_point start = Clock::now();
+    const int back = rewind->rollback(rewindTicks);
+    const Clock::time_point rolledBack = Clock::now();
+    const bool backOk = breakout::WorldChecksum(world, false) == worldChecksums[ticks - 1 - back];
+    const Clock::time_point forwardStart = Clock::now();
+    const int forth = rewind->forward(back);
+    const Clock::time_point rolledForward = Clock::now();
+    const bool forthOk = forth == back && breakout::WorldChecksum(world, false) == worldChecksums[ticks - 1];
+
+    std::cout << "Rewind: " << back << " ticks back in " << ms(rolledBack - start).count() << " ms ("
+              << (backOk ? "matches" : "DIFFERS from") << " tick " << ticks - 1 - back << "), forward in "
+              << ms(rolledForward - forwardStart).count() << " ms (" << (forthOk ? "matches" : "DIFFERS from")
+              << " tick " << ticks - 1 << "), " << bytes / 1024 << " KiB of deltas\n";
+    return backOk && forthOk ? 0 : 1;
+}
+
+/**
+ * @brief Builds a level and saves it as a snapshot for `--headless --level`:
+ * `BAGEL --save-level file [rows cols]` (default 4 x 6 bricks).
+ *
+ * Prints how long building, saving, and loading the snapshot back took.
+ */
+int runSaveLevel(int argc, char* argv[]) {
+    using Clock = std::chrono::steady_clock;
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --save-level file [rows cols]\n";
+        return 1;
+    }
+    const int rows = argc > 4 ? std::atoi(argv[3]) : 4;
+    const int cols = argc > 4 ? std::atoi(argv[4]) : 6;
+
+    breakout::GameWorld world;
+    bagel::World::Bind bind(world.ecs);
+    bagel::JobSystem jobs;
+    breakout::PhysicsTasks physicsTasks(jobs);
+    const Clock::time_point start = Clock::now();
+    if (!breakout::CreateLevel(world, physicsTasks, rows, cols)) {
+        std::cerr << "Failed to create the level\n";
+        return 1;
+    }
+    const Clock::time_point built = Clock::now();
+    if (!breakout::SaveLevel(world, argv[2])) {
+        std::cerr << "Failed to write " << argv[2] << "\n";
+        return 1;
+    }
+    const Clock::time_point saved = Clock::now();
+    if (!breakout::LoadLevel(world, argv[2], physicsTasks)) {
+        std::cerr << "Failed to read back " << argv[2] << "\n";
+        return 1;
+    }
+    const Clock::time_point loaded = Clock::now();
+
+    using ms = std::chrono::duration<double, std::milli>;
+    std::cout << bagel::World::maxId().id + 1 << " entities: built in " << ms(built - start).count()
+              << " ms, saved in " << ms(saved - built).count() << " ms, loaded in "
+              << ms(loaded - saved).count() << " ms\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--headless") == 0) return runHeadless(argc, argv);
+    if (argc > 1 && std::strcmp(argv[1], "--replay") == 0) return runReplay(argc, argv);
+    if (argc > 1 && std::strcmp(argv[1], "--save-level") == 0) return runSaveLevel(argc, argv);
+
+    // `BAGEL --record file`: play, and save the input of every tick for --replay
+    const char* recordPath = argc > 2 && std::strcmp(argv[1], "--record") == 0 ? argv[2] : nullptr;
+
     SDL_Window* window = nullptr;
     SDL_Renderer* renderer = nullptr;
     SDL_Texture* sheet = nullptr;
@@ -46,9 +289,14 @@ int main() {
     if (!init(window, renderer, sheet)) return -1;
 
     // ✅ Run the full ECS-based game
-    breakout::run(renderer, sheet);
+    breakout::InputLog log(60.0f);
+    breakout::run(renderer, sheet, 60.0f, 60.0f, recordPath ? &log : nullptr);
 
     cleanUp(window, renderer, sheet);
+    if (recordPath && !log.save(recordPath)) {
+        std::cerr << "Failed to write " << recordPath << "\n";
+        return 1;
+    }
     return 0;
 }
 